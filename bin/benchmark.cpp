@@ -0,0 +1,95 @@
+#include <iostream>
+#include <chrono>
+#include <iomanip>
+
+#include <boost/program_options.hpp>
+
+#include "jsonmodel.h"
+#include "helpers.h"
+#include "settings.h"
+
+using namespace mht;
+using namespace helpers;
+
+/**
+ * @brief Track the given model once and return the tracking time, the energy and whether the solution is valid
+ */
+double runTracking(const std::string& modelFilename, const std::vector<double>& weights, bool useCompactFormulation, double& energy, bool& valid)
+{
+	// models can only be used for inference once, so each run reads its own copy
+	JsonModel model;
+	model.readFromJson(modelFilename);
+	model.getSettings()->useCompactFormulation_ = useCompactFormulation;
+
+	// the specialized solvers would answer flow and tree models in both runs, so only the ILP formulations are compared
+	model.getSettings()->useMinCostFlowSolver_ = false;
+	model.getSettings()->useDynamicProgramming_ = false;
+	model.getSettings()->useGreedyStartingPoint_ = false;
+
+	std::chrono::time_point<std::chrono::high_resolution_clock> start = std::chrono::high_resolution_clock::now();
+	Solution solution = model.infer(weights);
+	std::chrono::time_point<std::chrono::high_resolution_clock> end = std::chrono::high_resolution_clock::now();
+
+	energy = model.getLastSolutionValue();
+	valid = model.verifySolution(solution);
+	std::chrono::duration<double> tracking_time = end - start;
+	return tracking_time.count();
+}
+
+int main(int argc, char** argv) {
+	namespace po = boost::program_options;
+
+	std::string modelFilename;
+	std::string weightsFilename;
+	size_t numRepetitions = 1;
+
+	// Declare the supported options.
+	po::options_description description("Compare tracking times of the indicator (one column per state) and the compact (one integer column per variable) ILP formulation.\nAllowed options");
+	description.add_options()
+	    ("help", "produce help message")
+	    ("model,m", po::value<std::string>(&modelFilename), "filename of model stored as Json file")
+	    ("weights,w", po::value<std::string>(&weightsFilename), "filename of the weights stored as Json file")
+	    ("repetitions,r", po::value<size_t>(&numRepetitions), "number of times each formulation is solved, default = 1")
+	;
+
+	po::variables_map variableMap;
+	po::store(po::parse_command_line(argc, argv, description), variableMap);
+	po::notify(variableMap);
+
+	if (variableMap.count("help"))
+	{
+	    std::cout << description << std::endl;
+	    return 1;
+	}
+
+	if (!variableMap.count("model") || !variableMap.count("weights"))
+	{
+	    std::cout << "Model and Weights filenames have to be specified!" << std::endl;
+	    std::cout << description << std::endl;
+	}
+	else
+	{
+        std::vector<double> weights = readWeightsFromJson(weightsFilename);
+        std::vector<std::string> names = {"indicator", "compact"};
+        std::vector<double> totalTimes(2, 0.0);
+        std::vector<double> energies(2, 0.0);
+        std::vector<bool> validities(2, true);
+
+        for(size_t r = 0; r < numRepetitions; ++r)
+        {
+        	for(size_t f = 0; f < 2; ++f)
+        	{
+        		bool valid = false;
+        		totalTimes[f] += runTracking(modelFilename, weights, f == 1, energies[f], valid);
+        		validities[f] = validities[f] && valid;
+        	}
+        }
+
+        std::cout << "\nformulation\taverage time [secs]\tenergy\t\tvalid" << std::endl;
+        for(size_t f = 0; f < 2; ++f)
+        {
+        	std::cout << names[f] << "\t" << std::setw(12) << totalTimes[f] / numRepetitions << "\t\t"
+        		<< energies[f] << "\t" << (validities[f] ? "yes" : "no") << std::endl;
+        }
+	}
+}
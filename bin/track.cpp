@@ -1,20 +1,45 @@
 #include <iostream>
 #include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <sstream>
+#include <memory>
+#include <limits>
 
 #include <boost/program_options.hpp>
 
 #include "jsonmodel.h"
+#include "resultcache.h"
 #include "helpers.h"
 
 using namespace mht;
 using namespace helpers;
 
+/**
+ * @brief Remove a trailing ".json" from the output filename, such that further result files can be named after it
+ */
+std::string stripJsonExtension(const std::string& filename)
+{
+	std::string extension = ".json";
+	if(filename.size() > extension.size() && filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0)
+		return filename.substr(0, filename.size() - extension.size());
+	return filename;
+}
+
 int main(int argc, char** argv) {
 	namespace po = boost::program_options;
 
 	std::string modelFilename;
 	std::string outputFilename;
 	std::string weightsFilename;
+	std::string weightsListFilename;
+	size_t numParallelSolves = 1;
+	size_t numSamples = 0;
+	double noiseScale = 1.0;
+	size_t initialLinksPerDetection = 0;
+	std::string cacheDirectory;
+	size_t cacheSizeInMegabytes = 1024;
+	double localSearchTimeLimit = 0.0;
 
 	// Declare the supported options.
 	po::options_description description("Allowed options");
@@ -25,6 +50,18 @@ int main(int argc, char** argv) {
 	    ("output,o", po::value<std::string>(&outputFilename), "filename where the resulting tracking (as links) will be stored as Json file")
 		("lp-relax", "run LP relaxation")
         ("cutting-constraints,c", "cut division and merger constraints")
+        ("flow-heuristic", "find an approximate solution with min cost flow only, no ILP solver needed")
+        ("reduced-ilp", "solve the LP relaxation, fix its integral variables and solve the rest as ILP")
+        ("link-pricing", po::value<size_t>(&initialLinksPerDetection), "column generation: start with this many cheapest incoming and outgoing links per detection and add links by reduced cost")
+        ("portfolio", "race several formulations in parallel threads and keep the first proven optimal result")
+        ("samples", po::value<size_t>(&numSamples), "perturb-and-MAP: also solve this many models with perturbed energies and save how often each variable is active to <output>_frequencies.json")
+        ("noise-scale", po::value<double>(&noiseScale), "scale of the noise for perturb-and-MAP, default 1")
+        ("gaussian-noise", "perturb with Gaussian instead of Gumbel noise")
+        ("weights-list", po::value<std::string>(&weightsListFilename), "text file with one weights Json filename per line, each is solved on the same model. Results are saved as <output>_<line>.json")
+        ("local-search", po::value<double>(&localSearchTimeLimit), "improve the solution by local moves for at most this many seconds, 0 = until no move improves it")
+        ("cache-dir", po::value<std::string>(&cacheDirectory), "existing directory where results are cached, an identical model, weights and options are then not solved again")
+        ("cache-size", po::value<size_t>(&cacheSizeInMegabytes), "size limit of the result cache in megabytes, least recently used results are removed beyond it. Default 1024, 0 = no limit")
+        ("parallel-solves", po::value<size_t>(&numParallelSolves), "number of weight vectors of the weights list (needs useCompactFormulation) or of perturbed samples that are solved at the same time")
 	;
 
 	po::variables_map variableMap;
@@ -37,7 +74,35 @@ int main(int argc, char** argv) {
 	    return 1;
 	}
 
-	if (!variableMap.count("model") || !variableMap.count("output") || !variableMap.count("weights"))
+	if (variableMap.count("model") && variableMap.count("output") && variableMap.count("weights-list"))
+	{
+		std::ifstream weightsList(weightsListFilename.c_str());
+		if(!weightsList.good())
+			throw std::runtime_error("Could not open weights list file " + weightsListFilename);
+
+		std::vector< std::vector<double> > weights;
+		std::string line;
+		while(std::getline(weightsList, line))
+		{
+			if(!line.empty())
+				weights.push_back(readWeightsFromJson(line));
+		}
+
+        JsonModel model;
+        model.readFromJson(modelFilename);
+
+        std::chrono::time_point<std::chrono::high_resolution_clock> start = std::chrono::high_resolution_clock::now();
+        std::vector<Solution> solutions = model.inferBatch(weights, numParallelSolves);
+        std::chrono::time_point<std::chrono::high_resolution_clock> end = std::chrono::high_resolution_clock::now();
+
+        std::chrono::duration<double> tracking_time = end - start;
+        std::cout << "Finished tracking " << solutions.size() << " weight vectors in " << tracking_time.count() << " secs" << std::endl;
+
+        std::string outputBase = stripJsonExtension(outputFilename);
+        for(size_t i = 0; i < solutions.size(); ++i)
+            model.saveResultToJson(outputBase + "_" + std::to_string(i) + ".json", solutions[i]);
+	}
+	else if (!variableMap.count("model") || !variableMap.count("output") || !variableMap.count("weights"))
 	{
 	    std::cout << "Model, Weights and Output filenames have to be specified!" << std::endl;
 	    std::cout << description << std::endl;
@@ -47,13 +112,67 @@ int main(int argc, char** argv) {
 		bool withIntegerConstraints = variableMap.count("lp-relax") == 0;
 		bool withAllConstraints = variableMap.count("cutting-constraints") == 0;
 
-        JsonModel model;
-        model.readFromJson(modelFilename);
+        std::ifstream modelInput(modelFilename.c_str());
+        if(!modelInput.good())
+            throw std::runtime_error("Could not open JSON model file " + modelFilename);
+        Json::Value modelJson;
+        modelInput >> modelJson;
         std::vector<double> weights = readWeightsFromJson(weightsFilename);
+
+        // perturb-and-MAP writes more than the result, so it is never cached
+        std::shared_ptr<ResultCache> cache;
+        std::string cacheKey;
+        if(variableMap.count("cache-dir") && numSamples == 0)
+        {
+            std::stringstream options;
+            options << "lp-relax=" << !withIntegerConstraints << ";cutting-constraints=" << !withAllConstraints
+                << ";flow-heuristic=" << variableMap.count("flow-heuristic") << ";portfolio=" << variableMap.count("portfolio")
+                << ";reduced-ilp=" << variableMap.count("reduced-ilp") << ";link-pricing=" << initialLinksPerDetection
+                << ";local-search=" << (variableMap.count("local-search") ? localSearchTimeLimit : -1.0);
+            cache = std::make_shared<ResultCache>(cacheDirectory, cacheSizeInMegabytes * 1024 * 1024);
+            cacheKey = ResultCache::computeKey(modelJson, weights, options.str());
+
+            Json::Value result;
+            if(cache->lookup(cacheKey, result))
+            {
+                std::ofstream output(outputFilename.c_str());
+                if(!output.good())
+                    throw std::runtime_error("Could not open JSON result file for saving: " + outputFilename);
+                output << result << std::endl;
+                std::cout << "Found result in cache with energy " << result[JsonTypeNames[JsonTypes::ResultEnergy]].asDouble() << std::endl;
+                return 0;
+            }
+        }
+
+        JsonModel model;
+        model.readFromJsonValue(modelJson);
         Solution solution;
 
         std::chrono::time_point<std::chrono::high_resolution_clock> start = std::chrono::high_resolution_clock::now();
-        if(withAllConstraints)
+        if(variableMap.count("flow-heuristic"))
+        {
+            solution = model.inferWithFlowHeuristic(weights);
+        }
+        else if(numSamples > 0)
+        {
+            std::vector<double> frequencies;
+            solution = model.inferPerturbAndMAP(weights, numSamples, frequencies, noiseScale, variableMap.count("gaussian-noise") == 0, numParallelSolves);
+
+            model.saveFrequenciesToJson(stripJsonExtension(outputFilename) + "_frequencies.json", frequencies);
+        }
+        else if(variableMap.count("portfolio"))
+        {
+            solution = model.inferPortfolio(weights);
+        }
+        else if(initialLinksPerDetection > 0)
+        {
+            solution = model.inferWithLinkPricing(weights, initialLinksPerDetection);
+        }
+        else if(variableMap.count("reduced-ilp"))
+        {
+            solution = model.inferReducedILP(weights);
+        }
+        else if(withAllConstraints)
         {
             solution = model.infer(weights, withIntegerConstraints);
         }
@@ -61,11 +180,18 @@ int main(int argc, char** argv) {
         {
             solution = model.inferWithCuttingConstraints(weights, withIntegerConstraints);
         }
+        if(variableMap.count("local-search"))
+        {
+            solution = model.improveByLocalSearch(solution, 
+                localSearchTimeLimit > 0.0 ? localSearchTimeLimit : std::numeric_limits<double>::infinity());
+        }
         std::chrono::time_point<std::chrono::high_resolution_clock> end = std::chrono::high_resolution_clock::now();
 
         std::chrono::duration<double> tracking_time = end - start;
         std::cout << "Finished tracking in " << tracking_time.count() << " secs" << std::endl;
 
         model.saveResultToJson(outputFilename, solution);
+        if(cache)
+            cache->store(cacheKey, model.resultToJson(solution));
 	}
 }
@@ -0,0 +1,231 @@
+#ifndef COMPACT_FORMULATION_H
+#define COMPACT_FORMULATION_H
+
+#include <vector>
+#include <limits>
+#include <map>
+#include <set>
+#include <memory>
+#include <atomic>
+
+#include "helpers.h"
+
+// settings forward declaration
+namespace helpers
+{
+	class Settings;
+}
+
+namespace mht
+{
+
+/**
+ * @brief An integer linear program where every opengm variable is represented by a single bounded integer column
+ * @details In contrast to the formulation of opengm's LP solvers, which uses one binary indicator column per state,
+ * the unary energies become piecewise linear costs over the integer values of a column.
+ * Constraints that only need to know whether a variable is active at all (exclusions, mergers, ...) use
+ * binary activity columns, which are only created for variables with more than two states.
+ * The first columns correspond 1:1 to the opengm variables, such that the solution can be read off directly.
+ * Rows can be put into lazy groups, which are only added to the model by a lazy constraint callback of the optimizer
+ * once an incumbent violates any row of the group.
+ */
+class CompactFormulation
+{
+public:
+	enum class RowOperator {LessEqual, Equal, GreaterEqual};
+
+	/// a row is a list of (column, coefficient) pairs
+	typedef std::vector< std::pair<size_t, helpers::ValueType> > RowType;
+
+	/**
+	 * @brief Create a formulation with one integer column per opengm variable. Set their costs with setStateEnergies()
+	 */
+	CompactFormulation(size_t numVariables);
+
+	/// the optimizer's model kept by resolve() refers to this formulation, so it can only be moved before that
+	CompactFormulation(const CompactFormulation&) = delete;
+	CompactFormulation(CompactFormulation&&) = default;
+	CompactFormulation& operator=(const CompactFormulation&) = delete;
+	CompactFormulation& operator=(CompactFormulation&&) = default;
+
+	/**
+	 * @brief Set the energy of every state of an opengm variable, which also defines the upper bound of its column
+	 */
+	void setStateEnergies(size_t variable, const std::vector<helpers::ValueType>& energies);
+
+	/**
+	 * @return the largest value the given column can take
+	 */
+	size_t getUpperBound(size_t column) const { return columnEnergies_.at(column).size() - 1; }
+
+	/**
+	 * @brief Get a binary column which is 1 if and only if the given column takes a value > 0
+	 * @details Binary columns are their own activity column, for all others an auxiliary column is created on first request
+	 */
+	size_t getActivityColumn(size_t column);
+
+	/**
+	 * @brief Add the linear constraint sum(coefficient * column) op bound, to the current lazy group if one is set
+	 */
+	void addRow(const RowType& row, RowOperator op, helpers::ValueType bound);
+
+	/**
+	 * @brief All rows added afterwards belong to the given lazy group, use -1 to add rows to the model right away again.
+	 * @details Rows that define activity columns are never lazy, because other groups may rely on them
+	 */
+	void setLazyGroup(int group) { lazyGroup_ = group; }
+
+	/**
+	 * @brief Check an incumbent against the rows of all lazy groups.
+	 * @details Groups that were added before cannot be violated, so no bookkeeping is needed, 
+	 * which keeps this safe if the optimizer calls back from several threads.
+	 * 
+	 * @param columnValues the value of every column
+	 * @return the indices of all rows of the violated groups
+	 */
+	std::vector<size_t> separateLazyRows(const std::vector<double>& columnValues) const;
+
+	const RowType& getRow(size_t row) const { return rows_.at(row); }
+	RowOperator getRowOperator(size_t row) const { return rowOperators_.at(row); }
+	helpers::ValueType getRowBound(size_t row) const { return rowBounds_.at(row); }
+
+	/**
+	 * @brief Add the row column + (M-1) * gate <= M, where M is the upper bound of the column,
+	 * such that the column can be at most 1 if the binary gate is active
+	 */
+	void addAtMostOneIfActiveRow(size_t column, size_t gate);
+
+	/**
+	 * @brief Fix the column of an opengm variable to the given value, the optimizer's presolve then removes it from the problem
+	 */
+	void fixColumn(size_t column, size_t value);
+
+	/**
+	 * @brief Pass a labeling of the opengm variables to the optimizer as MIP start in every following solve,
+	 *        an empty labeling removes the starting point again
+	 */
+	void setStartingPoint(const helpers::Solution& labeling);
+
+	/**
+	 * @return the number of rows that contain at least one column which is not fixed
+	 */
+	size_t getNumFreeRows() const;
+
+	/**
+	 * @brief Release a column that was fixed before
+	 */
+	void unfixColumn(size_t column);
+
+	size_t getNumFixedColumns() const { return fixedColumns_.size(); }
+	size_t getNumColumns() const { return columnEnergies_.size(); }
+	size_t getNumRows() const { return rows_.size(); }
+	size_t getNumLazyGroups() const { return lazyGroupRows_.size(); }
+
+	/**
+	 * @brief Solve the integer program with the optimizer this library was built with (CPLEX or Gurobi)
+	 *
+	 * @param settings provides the optimizer gap, verbosity and number of threads
+	 * @param energy will be set to the objective value of the found solution
+	 * @param bound will be set to the lower bound on the objective that the optimizer proved
+	 * @param timeLimit seconds after which the optimizer stops and the best solution found so far is returned
+	 * @param cancel if given, the optimizer stops as soon as another thread sets this flag
+	 * @return the value of the column of each opengm variable, i.e. a labeling of the opengm model
+	 */
+	helpers::Solution solve(
+		std::shared_ptr<helpers::Settings> settings, 
+		helpers::ValueType& energy, 
+		helpers::ValueType& bound, 
+		double timeLimit = std::numeric_limits<double>::infinity(),
+		const std::atomic<bool>* cancel = nullptr) const;
+
+	/**
+	 * @brief Solve the LP relaxation without lazy rows, where the cost of each column is the lower convex envelope of its energies
+	 *
+	 * @param settings provides the verbosity and number of threads
+	 * @param rowDuals will be set to the dual value of every row, zero for lazy rows
+	 * @return the objective value of the relaxation
+	 */
+	helpers::ValueType solveRelaxation(std::shared_ptr<helpers::Settings> settings, std::vector<double>& rowDuals) const;
+
+	/**
+	 * @brief Solve with other energies for the columns of the opengm variables, e.g. perturbed ones, keeping all rows
+	 * @details does not modify the formulation, so several threads can solve it with their own energies at the same time
+	 * 
+	 * @param variableEnergies energies of all states of each opengm variable, with as many states as set by setStateEnergies()
+	 */
+	helpers::Solution solve(
+		std::shared_ptr<helpers::Settings> settings, 
+		const std::vector< std::vector<helpers::ValueType> >& variableEnergies,
+		helpers::ValueType& energy, 
+		helpers::ValueType& bound, 
+		double timeLimit = std::numeric_limits<double>::infinity()) const;
+
+	/**
+	 * @brief Solve like solve(), but keep the optimizer's model for the next call
+	 * @details The first call builds the model, every following call only passes the energies and fixed columns 
+	 *          that changed in between to the optimizer as new costs and bounds of the same columns and reoptimizes it.
+	 *          Afterwards no rows or columns can be added anymore, and the number of states of a column must not change.
+	 */
+	helpers::Solution resolve(
+		std::shared_ptr<helpers::Settings> settings, 
+		helpers::ValueType& energy, 
+		helpers::ValueType& bound, 
+		double timeLimit = std::numeric_limits<double>::infinity());
+
+	/**
+	 * @return the energies of all states of the given column
+	 */
+	const std::vector<helpers::ValueType>& getStateEnergies(size_t column) const { return columnEnergies_.at(column); }
+
+private:
+	helpers::Solution solveWithEnergies(
+		std::shared_ptr<helpers::Settings> settings, 
+		const std::vector< std::vector<helpers::ValueType> >& columnEnergies,
+		helpers::ValueType& energy, 
+		helpers::ValueType& bound, 
+		double timeLimit, 
+		const std::atomic<bool>* cancel) const;
+
+	/// columns, objective and rows in the optimizer this library was built with, defined in the source file
+	struct OptimizerModel;
+
+	std::shared_ptr<OptimizerModel> buildOptimizerModel(
+		const std::vector< std::vector<helpers::ValueType> >& columnEnergies,
+		const std::atomic<bool>* cancel) const;
+
+	/// set the bounds and cost of a column in the optimizer's model
+	void setColumn(OptimizerModel& optimizerModel, size_t column, const std::vector<helpers::ValueType>& energies) const;
+	void setObjectiveConstant(OptimizerModel& optimizerModel, const std::vector< std::vector<helpers::ValueType> >& columnEnergies) const;
+
+	helpers::Solution optimize(
+		OptimizerModel& optimizerModel,
+		std::shared_ptr<helpers::Settings> settings, 
+		helpers::ValueType& energy, 
+		helpers::ValueType& bound, 
+		double timeLimit) const;
+
+private:
+	size_t numVariables_;
+
+	/// energy of each value of each column, auxiliary columns have zero energies
+	std::vector< std::vector<helpers::ValueType> > columnEnergies_;
+	std::map<size_t, size_t> activityColumns_;
+	std::map<size_t, size_t> fixedColumns_;
+	helpers::Solution startingPoint_;
+
+	std::vector<RowType> rows_;
+	std::vector<RowOperator> rowOperators_;
+	std::vector<helpers::ValueType> rowBounds_;
+
+	int lazyGroup_;
+	std::vector<bool> isLazyRow_;
+	std::vector< std::vector<size_t> > lazyGroupRows_;
+
+	/// the model of resolve(), and the columns whose energies or bounds changed since it was last updated
+	std::shared_ptr<OptimizerModel> optimizerModel_;
+	std::set<size_t> changedColumns_;
+};
+
+} // end namespace mht
+
+#endif // COMPACT_FORMULATION_H
@@ -42,12 +42,22 @@ public:
 	 * @param weights OpenGM weight object (if you are running learning this must be a reference to the weight object of the dataset)
 	 * @param statesShareWeights whether there is one weight per feature for all states, or a separate weight for each feature and state
 	 * @param weightIds indices of the weights that are meant to be used together with the features (size must match 2*numFeatures)
+	 * @param precomputeUnaries store the unary energies computed from the current weights instead of a learnable function
 	 */
 	void addToOpenGMModel(
 		helpers::GraphicalModelType& model, 
 		helpers::WeightsType& weights, 
 		bool statesShareWeights,
-		const std::vector<size_t>& weightIds);
+		const std::vector<size_t>& weightIds,
+		bool precomputeUnaries = false);
+
+	/**
+	 * @brief Count the variables, functions and factors that addToOpenGMModel() would add
+	 */
+	void countOpenGMModelSize(helpers::OpenGMModelSize& size, bool statesShareWeights, bool precomputeUnaries) const
+	{
+		variable_.countOpenGMModelSize(size, statesShareWeights, precomputeUnaries);
+	}
 
 	/**
 	 * @brief notify the three connected segmentation hypotheses about their new incoming/outgoing division link
@@ -65,6 +75,7 @@ public:
 	 * @return opengm variable
 	 */
 	const Variable& getVariable() const { return variable_; }
+	Variable& getVariable() { return variable_; }
 
 private:
 	helpers::IdLabelType parentId_;
@@ -24,8 +24,27 @@ public:
 	 * 
 	 * @param model OpenGM model
 	 * @param segmentationHypotheses the map of all segmentation hypotheses by id
+	 * @param allVariablesBinary set to true if every variable in the model has two states, then only state 1 needs to be considered
 	 */
-	void addToOpenGMModel(helpers::GraphicalModelType& model, std::map<helpers::IdLabelType, SegmentationHypothesis>& segmentationHypotheses);
+	void addToOpenGMModel(
+		helpers::GraphicalModelType& model, 
+		std::map<helpers::IdLabelType, SegmentationHypothesis>& segmentationHypotheses,
+		bool allVariablesBinary = false);
+
+	/**
+	 * @brief Add this constraint to the compact integer formulation, using the activity columns of all detections
+	 */
+	void addToCompactFormulation(
+		CompactFormulation& formulation,
+		const std::map<helpers::IdLabelType, SegmentationHypothesis>& segmentationHypotheses) const;
+
+	/**
+	 * @brief Count the constraint factor that addToOpenGMModel() would add
+	 */
+	void countOpenGMModelSize(
+		helpers::OpenGMModelSize& size,
+		const std::map<helpers::IdLabelType, SegmentationHypothesis>& segmentationHypotheses,
+		bool allVariablesBinary = false) const;
 
 	/**
 	 * @brief Check that the given solution vector obeys this exclusion constraint
@@ -40,6 +59,24 @@ public:
 	 */
 	void toDot(std::ostream& stream) const;
 
+	/**
+	 * @brief the ids of all segmentation hypotheses participating in this constraint
+	 */
+	const std::vector<helpers::IdLabelType>& getIds() const { return ids_; }
+
+	/**
+	 * @brief Build the conflict graph of all pairs of hypotheses that exclude each other 
+	 * and cover its edges greedily with maximal cliques.
+	 * 
+	 * @detail Each clique is grown from a not yet covered edge by repeatedly adding the common neighbor 
+	 * that covers the most new edges, so the runtime is bounded by the number of edges times 
+	 * the squared neighborhood size. The returned constraints allow exactly the same set of integer solutions.
+	 * 
+	 * @param constraints the exclusion constraints as specified in the input
+	 * @return one exclusion constraint per clique
+	 */
+	static std::vector<ExclusionConstraint> mergeIntoCliques(const std::vector<ExclusionConstraint>& constraints);
+
 private:
 	std::vector<helpers::IdLabelType> ids_;
 };
@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <vector>
+#include <map>
 
 // opengm
 #include <opengm/opengm.hxx>
@@ -44,10 +45,38 @@ typedef opengm::learning::Weights<ValueType> WeightsType;
 typedef LinearConstraintFunctionType::LinearConstraintType::IndicatorVariableType IndicatorVariableType;
 
 // other stuff
-typedef std::vector<ValueType> FeatureVector;
+#ifdef USE_FLOAT_FEATURES
+// features are only stored in single precision, energies and weights are still accumulated in ValueType
+typedef float FeatureValueType;
+#else
+typedef ValueType FeatureValueType;
+#endif
+typedef std::vector<FeatureValueType> FeatureVector;
 typedef std::vector<FeatureVector> StateFeatureVector;
 
 
+/**
+ * @brief Number of variables, functions and factors that will be added to the OpenGM model, 
+ * 		  used to reserve memory before the model is constructed
+ */
+struct OpenGMModelSize
+{
+	size_t numVariables = 0;
+	size_t numLearnableUnaries = 0;
+	size_t numLearnableWeightedSums = 0;
+	size_t numExplicitUnaries = 0;
+	size_t numConstraints = 0;
+	size_t numFactorVariables = 0; // sum over the number of variables of all factors
+
+	size_t numFactors() const { return numLearnableUnaries + numLearnableWeightedSums + numExplicitUnaries + numConstraints; }
+
+	void addConstraint(size_t numConstraintVariables)
+	{
+		numConstraints++;
+		numFactorVariables += numConstraintVariables;
+	}
+};
+
 #ifdef USE_STRING_IDS
 typedef std::string IdLabelType;
 #define asLabelType asString
@@ -120,6 +149,41 @@ void addOpenGMVariableStateToConstraint(
 	std::vector<LabelType>& factorVariables,
 	GraphicalModelType& model);
 
+/**
+ * @brief add the variable's value to the constraint, specialized at compile time for models in which every variable is binary.
+ * 		  Then the value of a variable equals the indicator of its state 1, so neither the loop over states nor 
+ * 		  the lookup of the number of labels is needed.
+ * 
+ * @tparam AllVariablesBinary whether every variable in the model has exactly two states
+ */
+template<bool AllVariablesBinary>
+inline void addOpenGMVariableStateToConstraint(
+	LinearConstraintFunctionType::LinearConstraintType& constraint, 
+	size_t opengmVariableId,
+	double coefficient,
+	std::vector<LabelType>& constraintShape,
+	std::vector<LabelType>& factorVariables,
+	GraphicalModelType& model)
+{
+	addOpenGMVariableStateToConstraint(constraint, opengmVariableId, coefficient, constraintShape, factorVariables, model);
+}
+
+template<>
+inline void addOpenGMVariableStateToConstraint<true>(
+	LinearConstraintFunctionType::LinearConstraintType& constraint, 
+	size_t opengmVariableId,
+	double coefficient,
+	std::vector<LabelType>& constraintShape,
+	std::vector<LabelType>& factorVariables,
+	GraphicalModelType& model)
+{
+	IndicatorVariableType indicatorVariable(constraintShape.size(), LabelType(1));
+	constraint.add(indicatorVariable, coefficient);
+
+	factorVariables.push_back(opengmVariableId);
+	constraintShape.push_back(2);
+}
+
 /**
  * @brief add the variable's value to the constraint, not just an indicator variable
  * 
@@ -134,6 +198,22 @@ void addConstraintToOpenGMModel(
 	std::vector<LabelType>& factorVariables,
 	GraphicalModelType& model);
 
+/**
+ * @brief add a constraint on a weighted sum of variable values to the model
+ * 
+ * @param coefficients the coefficient of each participating opengm variable, the map keeps them sorted and unique as opengm requires
+ * @param bound the right hand side of the constraint
+ * @param op the constraint operator
+ * @param model the opengm model
+ * @param allVariablesBinary set to true if every variable in the model has two states, then only state 1 needs to be considered
+ */
+void addValueConstraintToOpenGMModel(
+	const std::map<size_t, double>& coefficients,
+	double bound,
+	LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::ValueType op,
+	GraphicalModelType& model,
+	bool allVariablesBinary = false);
+
 // --------------------------------------------------------------
 // json type definitions
 // --------------------------------------------------------------
@@ -170,6 +250,17 @@ enum class JsonTypes {Segmentations,
 	AllowLengthOneTracks,
 	RequireSeparateChildrenOfDivision,
 	NonNegativeWeightsOnly,
+	MergeExclusionCliques,
+	UseCompactFormulation,
+	SubstituteAppearanceDisappearance,
+	UseMinCostFlowSolver,
+	UseGreedyStartingPoint,
+	UseLazyConstraints,
+	LazyExclusionConstraints,
+	UseDynamicProgramming,
+	OptimizerTimeLimit,
+	LookBackHorizon,
+	RoundRelaxedSolution,
 };
 
 /// mapping from JsonTypes to strings which are used in the Json files
@@ -0,0 +1,125 @@
+#ifndef INCREMENTAL_MODEL_H
+#define INCREMENTAL_MODEL_H
+
+#include <memory>
+#include <vector>
+#include <map>
+#include <set>
+#include <tuple>
+
+#include <json/json.h>
+#include "helpers.h"
+#include "settings.h"
+#include "divisionhypothesis.h"
+
+namespace mht
+{
+
+/**
+ * @brief Online tracking of a sequence that grows frame by frame
+ * @details Every appended frame holds the segmentation hypotheses of one time step, together with the links and divisions
+ *          that end in it and the exclusion constraints between its detections, in the same Json layout as a model file.
+ *          infer() only re-solves the last lookBackHorizon_ frames, all earlier decisions stay fixed.
+ *          Objects that enter the open frames along fixed links become a fixed incoming flow of their target, and detections
+ *          that are excluded by a fixed active one stay inactive. The open frames are solved as a JsonModel of their own,
+ *          so the effort per appended frame does not depend on the length of the sequence.
+ */
+class IncrementalModel
+{
+public:
+	/**
+	 * @param settings used for every re-solve, the look-back horizon is taken from lookBackHorizon_
+	 */
+	IncrementalModel(std::shared_ptr<helpers::Settings> settings = std::make_shared<helpers::Settings>());
+
+	/**
+	 * @brief Append the hypotheses of the next frame
+	 * @details links and divisions must end in this frame and start in this or an earlier one
+	 *
+	 * @param frame json object with segmentation, linking and division hypotheses and exclusions
+	 */
+	void appendFrame(const Json::Value& frame);
+
+	/**
+	 * @brief Read a frame from a json file and append it
+	 */
+	void appendFrameFromJson(const std::string& filename);
+
+	/**
+	 * @brief Re-solve the frames within the look-back horizon, keeping all earlier decisions fixed
+	 *
+	 * @param weights the weight vector of the full model, see computeNumWeights()
+	 */
+	void infer(const std::vector<helpers::ValueType>& weights);
+
+	/**
+	 * @return the number of weights needed for all frames appended so far, in the same order as in Model
+	 */
+	size_t computeNumWeights() const;
+
+	/**
+	 * @return the number of frames appended so far
+	 */
+	size_t getNumFrames() const { return frames_.size(); }
+
+	/**
+	 * @brief Return the energy of the open frames in the last re-solve
+	 */
+	double getLastSolutionValue() const { return lastSolutionValue_; }
+
+	/**
+	 * @brief Create a result json of the current states of all frames, with the same layout as JsonModel::saveResultToJson()
+	 */
+	Json::Value resultToJson() const;
+
+	/**
+	 * @brief Save the current states of all frames to a json file
+	 */
+	void saveResultToJson(const std::string& filename) const;
+
+	/**
+	 * @return the settings, which can be modified before calling infer()
+	 */
+	std::shared_ptr<helpers::Settings> getSettings() { return settings_; }
+
+private:
+	/// keep the maximal number of weights of any variable of this kind
+	void updateNumWeights(const Json::Value& entry, helpers::JsonTypes type, size_t& numWeights);
+
+	/// the state of a detection, zero if it has not been solved yet
+	size_t getDetectionState(helpers::IdLabelType id) const;
+
+	/// build the model of the open frames
+	Json::Value buildWindow(
+		const std::set<helpers::IdLabelType>& openDetections,
+		std::map<helpers::IdLabelType, size_t>& fixedIncomingFlow) const;
+
+	/// take over the states of the open frames from the result of the window
+	void readWindowResult(const Json::Value& result, const std::set<helpers::IdLabelType>& openDetections);
+
+private:
+	std::shared_ptr<helpers::Settings> settings_;
+
+	std::vector<Json::Value> frames_;
+	std::map<helpers::IdLabelType, size_t> frameOfDetection_;
+
+	// number of weights per kind of variable
+	size_t numLinkWeights_;
+	size_t numDetWeights_;
+	size_t numDivWeights_;
+	size_t numAppWeights_;
+	size_t numDisWeights_;
+	size_t numExternalDivWeights_;
+
+	// current states of all variables that are active
+	std::map<helpers::IdLabelType, size_t> detectionStates_;
+	std::map<helpers::IdLabelType, size_t> divisionStates_;
+	std::map<std::pair<helpers::IdLabelType, helpers::IdLabelType>, size_t> linkStates_;
+	std::map<DivisionHypothesis::IdType, size_t> externalDivisionStates_;
+
+	double lastSolutionValue_;
+};
+
+} // end namespace mht
+
+#endif // INCREMENTAL_MODEL_H
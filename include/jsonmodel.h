@@ -26,6 +26,12 @@ public:
      */
     void readFromJson(const std::string& filename);
 
+    /**
+     * @brief Read a model from an already parsed json value, which has the same layout as the model file
+     * @param root
+     */
+    void readFromJsonValue(const Json::Value& root);
+
     /**
      * @brief Export a found solution vector as a readable json file
      * 
@@ -34,6 +40,23 @@ public:
      */
     void saveResultToJson(const std::string& filename, const helpers::Solution& sol) const;
 
+    /**
+     * @brief Create the json value that saveResultToJson() writes
+     * 
+     * @param sol the labeling to export
+     * @return json object with the active links, divisions and detections and the energy
+     */
+    Json::Value resultToJson(const helpers::Solution& sol) const;
+
+    /**
+     * @brief Save how often each link, division and detection was active, e.g. the result of Model::inferPerturbAndMAP()
+     * @details uses the layout of the result file, but lists every hypothesis with its frequency as "value"
+     * 
+     * @param filename where to save the frequencies
+     * @param frequencies one value per opengm variable
+     */
+    void saveFrequenciesToJson(const std::string& filename, const std::vector<double>& frequencies) const;
+
     /**
      * @brief Read in a ground truth solution (a boolean value per link) from a json file
      * 
@@ -0,0 +1,114 @@
+#ifndef MIN_COST_FLOW_H
+#define MIN_COST_FLOW_H
+
+#include <vector>
+
+#include "helpers.h"
+
+namespace mht
+{
+
+/**
+ * @brief A successive shortest path min cost flow solver on a graph of unit capacity arcs
+ * @details Flow is sent from the source to the sink as long as there is an augmenting path of negative cost,
+ * so the amount of flow is part of the optimization. Node potentials are initialized with Bellman-Ford (arc costs may be negative),
+ * afterwards each augmenting path is found with Dijkstra on the reduced costs.
+ * A variable with several states is represented by parallel unit arcs with the energy differences of consecutive states as costs,
+ * which is only exact if these costs are non-decreasing (the energy is convex in the state).
+ */
+class MinCostFlow
+{
+public:
+	/**
+	 * @brief Create a graph with the given number of nodes and no arcs
+	 */
+	MinCostFlow(size_t numNodes, size_t source, size_t sink);
+
+	/**
+	 * @brief Add an arc with capacity one
+	 * @return the index of the arc, which can be used to query its flow after solving
+	 */
+	size_t addArc(size_t from, size_t to, helpers::ValueType cost);
+
+	/**
+	 * @brief Find the flow of minimal cost
+	 * @details throws a std::runtime_error if the graph contains a cycle of negative cost
+	 * @return the cost of the flow
+	 */
+	helpers::ValueType solve();
+
+	/**
+	 * @brief Blocked arcs are ignored when searching paths, so their flow stays fixed (in both directions)
+	 */
+	void setBlocked(size_t arc, bool blocked) { blocked_[arc] = blocked; }
+
+	/**
+	 * @brief Find the cheapest path with free capacity in the residual graph with Bellman-Ford, which allows negative costs
+	 * 
+	 * @param from start node
+	 * @param to end node
+	 * @param path will be filled with the residual arcs of the path (see getResidualArc())
+	 * @param pathCost will be set to the cost of the path
+	 * @return false if there is no path or a negative cycle was encountered
+	 */
+	bool findCheapestPath(size_t from, size_t to, std::vector<size_t>& path, helpers::ValueType& pathCost) const;
+
+	/**
+	 * @brief Send one unit of flow along the given residual arcs, or take it back if cancel is true
+	 */
+	void augmentPath(const std::vector<size_t>& path, bool cancel = false);
+
+	/**
+	 * @return the residual arc that sends flow along the given arc, or the one that takes flow back from it
+	 */
+	size_t getResidualArc(size_t arc, bool backward = false) const { return 2 * arc + (backward ? 1 : 0); }
+
+	/**
+	 * @return true if the given arc carries flow
+	 */
+	bool hasFlow(size_t arc) const { return arcs_[2 * arc].capacity == 0; }
+
+	/**
+	 * @return the number of units sent from source to sink
+	 */
+	size_t getFlowValue() const { return flowValue_; }
+
+	size_t getNumNodes() const { return outgoingArcs_.size(); }
+	size_t getNumArcs() const { return arcs_.size() / 2; }
+
+private:
+	/// arcs are stored in pairs, the forward arc at an even index and its residual arc right after it
+	struct Arc
+	{
+		size_t to;
+		helpers::ValueType cost;
+		int capacity;
+	};
+
+	/**
+	 * @brief initialize the node potentials by shortest path distances from the source, such that all reduced costs are non-negative
+	 */
+	void initializePotentials();
+
+	/**
+	 * @brief run Dijkstra on the reduced costs from the source and update the potentials
+	 * 
+	 * @param predecessorArcs will be filled with the arc through which each node is reached on its shortest path
+	 * @param pathCost will be set to the (original) cost of the shortest path from source to sink
+	 * @return false if the sink is not reachable
+	 */
+	bool findShortestPath(std::vector<size_t>& predecessorArcs, helpers::ValueType& pathCost);
+
+private:
+	std::vector<Arc> arcs_;
+	std::vector< std::vector<size_t> > outgoingArcs_;
+	std::vector<bool> blocked_;
+	std::vector<helpers::ValueType> potentials_;
+	size_t source_;
+	size_t sink_;
+	size_t flowValue_;
+};
+
+} // end namespace mht
+
+#endif // MIN_COST_FLOW_H
@@ -4,6 +4,12 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <functional>
+#include <set>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <random>
 
 #include "segmentationhypothesis.h"
 #include "linkinghypothesis.h"
@@ -11,10 +17,23 @@
 #include "divisionhypothesis.h"
 #include "helpers.h"
 #include "settings.h"
+#include "mincostflow.h"
+#include "compactformulation.h"
+#include "treedynamicprogram.h"
 
 namespace mht
 {
 
+/**
+ * @brief One configuration of the compact formulation that Model::inferPortfolio() races against others
+ */
+struct PortfolioStrategy
+{
+	std::string name;
+	bool lazyDivisionAndMergerConstraints;
+	bool lazyExclusionConstraints;
+};
+
 /**
  * @brief The model holds all detections and their links, as well as exclusion constraints between detections
  * @detail WARNING: at the moment you can only run either learn or infer once on the model.
@@ -28,19 +47,214 @@ public:
 	 */
 	size_t computeNumWeights();
 
+	/**
+	 * @brief Use the given number of weights per variable type instead of estimating them from the features,
+	 * 		  e.g. if the model is only a part of a larger one that shares its weight vector
+	 */
+	void setNumWeights(size_t numLinkWeights, size_t numDetWeights, size_t numDivWeights, 
+		size_t numAppWeights, size_t numDisWeights, size_t numExternalDivWeights);
+
+	/**
+	 * @brief Let the given number of objects enter a detection along links that are not part of the model
+	 */
+	void setFixedIncomingFlow(helpers::IdLabelType id, size_t flow);
+
     /**
-     * @brief Find the solution starting without division and merger constraints and adding them gradually
+     * @brief Find the solution starting without division and merger constraints and adding them gradually.
+     * @details With the setting useLazyConstraints_ (and integer constraints) this happens in a single solve of the compact formulation,
+     *          where the optimizer's lazy constraint callback adds the constraints of each detection at which an incumbent violates them.
+     *          With lazyExclusionConstraints_, exclusion constraints are also only added once a solution violates them.
      */
 	helpers::Solution inferWithCuttingConstraints(const std::vector<helpers::ValueType>& weights, bool withIntegerConstraints = true);
 
 	/**
 	 * @brief Find the minimal-energy configuration using an ILP
 	 * @param weights a vector of weights to use
-	 * @param withIntegerConstraints set to false if you just want the LP relaxation. Don't expect the solution to work in the rest of the code!
+	 * @param withIntegerConstraints set to false if you just want the LP relaxation. Don't expect the solution to work in the rest of the code,
+	 *        unless the setting roundRelaxedSolution_ is enabled!
 	 * @return the vector of per-variable labels, can be used with the detection/linking hypotheses to query their state
 	 */
 	helpers::Solution infer(const std::vector<helpers::ValueType>& weights, bool withIntegerConstraints = true, bool withDivisionConstraints = true, bool withMergerConstrains = true);
 
+	/**
+	 * @brief Solve the LP relaxation first, fix every variable that it assigns integrally, and solve only the remaining
+	 *        fractional part as ILP (in the compact formulation). Much faster than the full ILP if the relaxation is mostly integral.
+	 * @details The energy is reported together with the gap to the bound of the relaxation. If the fixed states leave no feasible
+	 *          completion, the relaxation is rounded with roundRelaxedSolution() instead.
+	 * @param weights a vector of weights to use
+	 * @return the vector of per-variable labels
+	 */
+	helpers::Solution inferReducedILP(const std::vector<helpers::ValueType>& weights);
+
+	/**
+	 * @brief Solve the compact formulation with column generation over the links
+	 * @details Starts with the cheapest incoming and outgoing links of every detection, solves the LP relaxation and adds all
+	 *          links with negative reduced cost (from the row duals) until there are none left. The ILP is then solved on the
+	 *          links that were needed, and the relaxation over all links is reported as lower bound. If the time limit stops
+	 *          the pricing before that, the Lagrangian bound from the last duals is reported instead.
+	 * @param weights a vector of weights to use
+	 * @param initialLinksPerDetection how many incoming and how many outgoing links of each detection are in the initial set
+	 * @return the vector of per-variable labels
+	 */
+	helpers::Solution inferWithLinkPricing(const std::vector<helpers::ValueType>& weights, size_t initialLinksPerDetection = 2);
+
+	/**
+	 * @brief Solve the model with several strategies at the same time, each in its own thread with a share of optimizerNumThreads_
+	 * @details The first strategy that proves its solution optimal (within optimizerEpGap_) wins and cancels the others.
+	 *          If none does so before optimizerTimeLimit_, the best solution wins. The winner is printed.
+	 * @param weights a vector of weights to use
+	 * @param strategies the configurations of the compact formulation to race
+	 * @return the vector of per-variable labels
+	 */
+	helpers::Solution inferPortfolio(
+		const std::vector<helpers::ValueType>& weights, 
+		const std::vector<PortfolioStrategy>& strategies = getDefaultPortfolio());
+
+	/**
+	 * @return the compact formulation with all constraints, with lazy division and merger constraints, and with all constraints lazy
+	 */
+	static std::vector<PortfolioStrategy> getDefaultPortfolio();
+
+	/**
+	 * @brief Perturb-and-MAP sampling: solve the model, and numSamples copies whose unary energies are perturbed by random noise
+	 * @details The copies share the rows of one compact formulation, numParallelSolves of them are solved at the same time,
+	 *          each with its share of optimizerNumThreads_. 
+	 * @param weights a vector of weights to use
+	 * @param numSamples number of perturbed copies
+	 * @param activationFrequencies will contain for each opengm variable the fraction of samples in which it is active (state > 0)
+	 * @param noiseScale scale of the Gumbel, or standard deviation of the Gaussian noise on the energy of every state, see perturbEnergies()
+	 * @param gumbelNoise use Gumbel noise if true, Gaussian noise otherwise
+	 * @param seed the noise of sample k is drawn with seed + k
+	 * @return the unperturbed MAP solution
+	 */
+	helpers::Solution inferPerturbAndMAP(
+		const std::vector<helpers::ValueType>& weights, 
+		size_t numSamples, 
+		std::vector<double>& activationFrequencies,
+		double noiseScale = 1.0, 
+		bool gumbelNoise = true, 
+		size_t numParallelSolves = 1, 
+		unsigned int seed = 0);
+
+	/**
+	 * @brief Add the noise of inferPerturbAndMAP() to the energies of all states of one variable
+	 * @details With Gumbel noise, the state of minimal perturbed energy is distributed as softmax(-energies / noiseScale)
+	 */
+	static void perturbEnergies(std::vector<helpers::ValueType>& energies, double noiseScale, bool gumbelNoise, std::mt19937& generator);
+
+	/**
+	 * @brief Find the minimal-energy configuration for each of the given weight vectors, building the model only once
+	 * @details The unaries are not precomputed but refer to the weights, so only the objective changes between solves.
+	 *          Each solve starts from the previous solution, which is feasible because the constraints do not depend on the weights.
+	 *          With the compact formulation, one formulation is built and each weight vector only brings its own energies.
+	 *          Up to numParallelSolves solves then run in parallel, share the optimizer threads and all start from the first solution.
+	 *          The optimizerTimeLimit_ of the settings applies to each solve separately.
+	 * @param weightsList one weight vector per solve
+	 * @param numParallelSolves how many solves may run at the same time (only with useCompactFormulation_)
+	 * @return one solution per weight vector
+	 */
+	std::vector<helpers::Solution> inferBatch(const std::vector< std::vector<helpers::ValueType> >& weightsList, size_t numParallelSolves = 1);
+
+	/**
+	 * @brief Solve the compact formulation and keep it for interactive editing
+	 * @details Afterwards features and weights can be changed and hypotheses fixed to a state, which only updates 
+	 *          the costs and bounds of the affected columns. The optimizer's model is kept as well, so resolve() passes 
+	 *          just these changes to it and reoptimizes, starting from the previous solution. The unaries of the opengm model 
+	 *          are updated along, such that evaluateSolution() agrees. Any other inference method ends interactive inference.
+	 * @param weights a vector of weights to use
+	 * @return the vector of per-variable labels
+	 */
+	helpers::Solution inferInteractive(const std::vector<helpers::ValueType>& weights);
+
+	/**
+	 * @brief Solve the kept compact formulation again after edits, with the previous solution as starting point
+	 * @detail WARNING: may only be used after calling inferInteractive()
+	 * @return the vector of per-variable labels
+	 */
+	helpers::Solution resolve();
+
+	/**
+	 * @brief Replace the weights of interactive inference, which recomputes the energies of all variables
+	 */
+	void setInteractiveWeights(const std::vector<helpers::ValueType>& weights);
+
+	/**
+	 * @brief Replace the features of a variable of a segmentation hypothesis, the number of states and features per state must stay the same
+	 *
+	 * @param id the segmentation hypothesis
+	 * @param type one of Features, DivisionFeatures, AppearanceFeatures or DisappearanceFeatures
+	 * @param features the new features of every state
+	 */
+	void setDetectionFeatures(helpers::IdLabelType id, helpers::JsonTypes type, const helpers::StateFeatureVector& features);
+
+	/**
+	 * @brief Replace the features of a link, the number of states and features per state must stay the same
+	 */
+	void setLinkFeatures(helpers::IdLabelType srcId, helpers::IdLabelType destId, const helpers::StateFeatureVector& features);
+
+	/**
+	 * @brief Fix a variable of a segmentation hypothesis to a state in all following calls to resolve(), e.g. 0 forbids it
+	 * @detail WARNING: may only be used after calling inferInteractive()
+	 * @param type one of Features, DivisionFeatures, AppearanceFeatures or DisappearanceFeatures
+	 */
+	void fixDetectionState(helpers::IdLabelType id, helpers::JsonTypes type, size_t state);
+
+	/**
+	 * @brief Fix a link to a state in all following calls to resolve(), e.g. 0 forbids it
+	 * @detail WARNING: may only be used after calling inferInteractive()
+	 */
+	void fixLinkState(helpers::IdLabelType srcId, helpers::IdLabelType destId, size_t state);
+
+	/**
+	 * @brief Let the optimizer choose the state of a variable of a segmentation hypothesis again
+	 */
+	void releaseDetectionState(helpers::IdLabelType id, helpers::JsonTypes type);
+
+	/**
+	 * @brief Let the optimizer choose the state of a link again
+	 */
+	void releaseLinkState(helpers::IdLabelType srcId, helpers::IdLabelType destId);
+
+	/**
+	 * @brief Find a good (but not necessarily optimal) solution with min cost flow computations only, no ILP solver is needed
+	 * @details First the flow problem without divisions is solved repeatedly, where variables that violate exclusion, 
+	 *          length one track or merger appearance constraints are forbidden in the next round. 
+	 *          Then divisions are added greedily whenever sending a second unit out of a detection along the cheapest 
+	 *          path reduces the energy, where the path has to start with an unused link if separate children are required. 
+	 *          The result always passes verifySolution(), 
+	 *          if the heuristic fails the empty tracking is returned.
+	 *          Useful as quick preview or as starting point for the ILP.
+	 * @param weights a vector of weights to use
+	 * @return the vector of per-variable labels
+	 */
+	helpers::Solution inferWithFlowHeuristic(const std::vector<helpers::ValueType>& weights);
+
+	/**
+	 * @brief Improve a feasible solution by local moves that keep it feasible, e.g. after an LP rounding or a time-limited solve
+	 * @details Each pass tries to swap the targets of two active links, merge a track that disappears with one that appears 
+	 *          along an inactive link, split a track at a link into a disappearance and an appearance, and remove whole tracks
+	 *          that appear and disappear without dividing. A move is kept if its energy delta (from the unaries of the changed 
+	 *          variables) is negative and the touched detections still satisfy their constraints. Moves only create links 
+	 *          carrying a single object and only switch detections off, so merger, division and exclusion constraints stay satisfied.
+	 *          Stops at a local optimum or when the time limit is reached, and updates getLastSolutionValue().
+	 * @detail WARNING: may only be used after calling infer() or initializeOpenGMModel(), because the energies are read from the opengm model
+	 * @param solution a labeling that passes verifySolution()
+	 * @param timeLimit seconds after which the search stops
+	 * @return the improved labeling, or the given one if it is infeasible or contains substituted variables
+	 */
+	helpers::Solution improveByLocalSearch(const helpers::Solution& solution, double timeLimit = std::numeric_limits<double>::infinity());
+
+	/**
+	 * @brief Construct a feasible solution greedily, without any solver
+	 * @details Detections are visited in topological order along the links (frame by frame). Objects that arrive at a detection
+	 *          either all disappear or each one takes the cheapest free link, a new track starts if it pays off within one step,
+	 *          and a single object divides if a second link reduces the energy. A detection only receives objects if none 
+	 *          of its exclusion partners is active and it could still let them disappear, so the result satisfies all constraints.
+	 * @detail WARNING: may only be used after calling initializeOpenGMModel(), because the energies are read from the opengm model
+	 * @return a labeling that passes verifySolution(), or the empty tracking if something unexpected (e.g. cyclic links) happens
+	 */
+	helpers::Solution findGreedySolution() const;
+
 	/**
 	 * @brief Run learning using a given ground truth file and initial weights
 	 * @details Loads the ground truth using getGroundTruth() and learns the best weights using Structured Bundled Risk Minimization
@@ -70,7 +284,7 @@ public:
      * @brief check that the solution does not violate any constraints, save the IDs of segmentationHypothesis in which constraints are broken
      * @detail used by relaxedInfer
      */
-	bool verifySolution(const helpers::Solution& sol, std::set<int>& divisionIDs) const;
+	bool verifySolution(const helpers::Solution& sol, std::set<helpers::IdLabelType>& divisionIDs) const;
 
 	/**
 	 * @brief Return the energy of the given solution vector
@@ -87,6 +301,22 @@ public:
 	 */
 	double getLastSolutionValue() const;
 
+	/**
+	 * @brief Return the lower bound on the energy that was proven during the last tracking, 
+	 *        which equals the energy of the solution unless the time limit stopped the optimizer early
+	 */
+	double getLastSolutionBound() const;
+
+	/**
+	 * @brief Return the relative gap between the energy and the lower bound of the last tracking
+	 */
+	double getLastSolutionGap() const;
+
+	/**
+	 * @return the settings of this model, which can be modified before calling learn() or infer()
+	 */
+	std::shared_ptr<helpers::Settings> getSettings() { return settings_; }
+
 	/**
 	 * @brief Create a graphviz dot output of the full graph, showing used nodes/links in blue and exclusion constraints in red
 	 *
@@ -100,8 +330,32 @@ public:
 	 * @detail This is called by learn() or infer()
 	 *
 	 * @param weights a reference to the weights object that will be used in all
+	 * @param withDivisionConstraints add all division constraints right away
+	 * @param withMergerConstrains add all merger constraints right away
+	 * @param precomputeUnaries evaluate all unaries once with the given weights and store them as explicit functions.
+	 *        Only valid if the weights do not change afterwards, i.e. not for learning!
+	 * @param substituteAppearanceDisappearance replace appearance and disappearance variables by the flow conservation constraints where possible
+	 *        and move their energy to the remaining variables. Requires precomputed unaries, and the solution must be completed with
+	 *        reconstructSubstitutedVariables(). Constraints that are added later on must not reference appearances/disappearances!
+	 * @param withExclusionConstraints add all exclusion constraints right away
+	 */
+	void initializeOpenGMModel(
+		helpers::WeightsType& weights, 
+		bool withDivisionConstraints = true, 
+		bool withMergerConstrains = true, 
+		bool precomputeUnaries = false, 
+		bool substituteAppearanceDisappearance = false,
+		bool withExclusionConstraints = true);
+
+	/**
+	 * @brief Count how many variables, functions and factors initializeOpenGMModel() will create with the given parameters
 	 */
-	void initializeOpenGMModel(helpers::WeightsType& weights, bool withDivisionConstraints = true, bool withMergerConstrains = true);
+	helpers::OpenGMModelSize countOpenGMModelSize(
+		bool withDivisionConstraints = true, 
+		bool withMergerConstrains = true, 
+		bool precomputeUnaries = false, 
+		bool allVariablesBinary = false,
+		bool withExclusionConstraints = true) const;
 
 	/**
 	 * @return a vector of strings describing each entry in the weight vector
@@ -115,6 +369,201 @@ public:
 	virtual helpers::Solution getGroundTruth() = 0;
 
 protected:
+	/**
+	 * @return the seconds left until the settings' optimizerTimeLimit_ is used up since the inference started, 
+	 *         infinity if there is no time limit
+	 */
+	double getRemainingTime() const;
+
+	/**
+	 * @brief print the lower bound and gap of the last found solution
+	 */
+	void printBoundAndGap() const;
+
+	/**
+	 * @return the indices into the weight vector that belong to the given kind of features, 
+	 *         one of Links, Features, DivisionFeatures, AppearanceFeatures, DisappearanceFeatures or Divisions (external)
+	 */
+	std::vector<size_t> getWeightIds(helpers::JsonTypes type) const;
+
+	/**
+	 * @brief Put the given weights into an opengm weight object, throws if their number does not match computeNumWeights()
+	 */
+	helpers::WeightsType makeWeightObject(const std::vector<helpers::ValueType>& weights);
+
+	/**
+	 * @brief Compute the unary energies of every opengm variable for the given weights from the features, 
+	 *        without touching the opengm model. Safe to call from several threads.
+	 */
+	std::vector< std::vector<helpers::ValueType> > computeVariableEnergies(const std::vector<helpers::ValueType>& weights) const;
+
+	/**
+	 * @brief Find a variable of a segmentation hypothesis, throws if the hypothesis does not exist
+	 */
+	Variable& getDetectionVariable(helpers::IdLabelType id, helpers::JsonTypes type);
+
+	/**
+	 * @brief Find the variable of a link, throws if the link does not exist
+	 */
+	Variable& getLinkVariable(helpers::IdLabelType srcId, helpers::IdLabelType destId);
+
+	/**
+	 * @brief Replace the features of a variable and update its energies in the interactive formulation
+	 */
+	void setVariableFeatures(Variable& variable, helpers::JsonTypes type, const helpers::StateFeatureVector& features);
+
+	/**
+	 * @brief Recompute the energies of a variable and set them in the interactive formulation as well as in the opengm model
+	 */
+	void updateInteractiveEnergies(const Variable& variable, helpers::JsonTypes type, const helpers::WeightsType& weights);
+
+	/**
+	 * @return the column of a variable in the interactive formulation, throws if there is none
+	 */
+	size_t getInteractiveColumn(const Variable& variable) const;
+
+	/**
+	 * @brief call the given function for each variable of all segmentation, linking and division hypotheses
+	 */
+	void forEachVariable(const std::function<void(const Variable&)>& function) const;
+
+	/**
+	 * @return true if every variable that has features can take exactly two states
+	 */
+	bool hasOnlyBinaryVariables() const;
+
+	/**
+	 * @brief Build the compact formulation of the initialized model with the current energies, see inferCompactFormulation()
+	 * @param skippedDetections detections whose variables (and links) are left out, their columns are fixed to state 0
+	 */
+	CompactFormulation buildCompactFormulation(
+		bool withDivisionConstraints, 
+		bool withMergerConstrains, 
+		bool lazyDivisionAndMergerConstraints = false, 
+		bool lazyExclusionConstraints = false,
+		const std::set<helpers::IdLabelType>& skippedDetections = std::set<helpers::IdLabelType>());
+
+	/**
+	 * @brief Solve the initialized model with the compact formulation, where each variable is one integer column 
+	 * instead of one indicator per state
+	 * @param lazyDivisionAndMergerConstraints only add division and merger constraints of a detection through a lazy constraint callback,
+	 *        once an incumbent violates one of them
+	 * @param lazyExclusionConstraints same for each exclusion constraint
+	 * @detail WARNING: may only be used after calling initializeOpenGMModel(), because the energies are read from the opengm model
+	 */
+	helpers::Solution inferCompactFormulation(
+		bool withDivisionConstraints, 
+		bool withMergerConstrains, 
+		bool lazyDivisionAndMergerConstraints = false, 
+		bool lazyExclusionConstraints = false);
+
+	/**
+	 * @brief Group the detections into connected components along links, external divisions and exclusion constraints,
+	 *        and find the components that a TreeDynamicProgram can solve: their links form a tree (ignoring the direction)
+	 *        and they contain no exclusion constraints and no external divisions
+	 * @param treeDetections will be filled with the detections of all tree components
+	 * @return the number of components
+	 */
+	size_t findTreeComponents(std::set<helpers::IdLabelType>& treeDetections) const;
+
+	/**
+	 * @brief Solve the given detections (which must form tree components, see findTreeComponents()) exactly by dynamic programming
+	 *        and write the states of their variables into the solution, all other entries are left untouched
+	 * @detail WARNING: may only be used after calling initializeOpenGMModel() without substitution, because the energies are read from the opengm model
+	 * @return the energy of the tree components
+	 */
+	helpers::ValueType inferTreeComponents(
+		const std::set<helpers::IdLabelType>& treeDetections, 
+		bool withDivisionConstraints, 
+		bool withMergerConstrains, 
+		helpers::Solution& solution) const;
+
+	/**
+	 * @brief Solve the initialized model as min cost flow problem if it has no divisions, exclusions and no merger or length one constraints 
+	 *        that need the activity of a variable, and all energies are convex in the state
+	 * @detail WARNING: may only be used after calling initializeOpenGMModel(), because the energies are read from the opengm model
+	 * 
+	 * @param withMergerConstrains whether merger constraints should be respected
+	 * @param solution will be filled with the optimal labeling
+	 * @return false if the model is not a min cost flow problem, then the solution is left untouched
+	 */
+	bool inferMinCostFlow(bool withMergerConstrains, helpers::Solution& solution);
+
+	/**
+	 * @brief Build the flow graph of the initialized model: every detection is split into an in- and an out-node, 
+	 *        source = 0 and sink = 1, and every variable becomes parallel unit arcs with its energy increments as costs.
+	 *        Division arcs lead from the source to the out-node and are blocked, such that they are only used when augmented explicitly.
+	 * 
+	 * @param blockedVariables opengm ids of variables which get no arcs, i.e. they are fixed to state 0
+	 * @param inNodes will be filled with the in-node of each detection, its out-node is the next one
+	 * @param variableArcs will be filled with the arcs of each opengm variable
+	 * @param constantEnergy will be set to the energy of the labeling where all variables are in state 0
+	 */
+	MinCostFlow buildMinCostFlowGraph(
+		const std::set<size_t>& blockedVariables,
+		std::map<helpers::IdLabelType, size_t>& inNodes,
+		std::map<size_t, std::vector<size_t> >& variableArcs,
+		helpers::ValueType& constantEnergy) const;
+
+	/**
+	 * @return the labeling where each variable's state is the number of its arcs that carry flow
+	 */
+	helpers::Solution readFlowLabeling(const MinCostFlow& flow, const std::map<size_t, std::vector<size_t> >& variableArcs) const;
+
+	/**
+	 * @brief Find the variables that make a flow labeling violate exclusion, length one track or merger appearance constraints
+	 *        (or the checks of verifySolution()) and add them to the set of blocked variables
+	 * @return the number of newly blocked variables, zero if the labeling is valid
+	 */
+	size_t blockFlowHeuristicViolations(const helpers::Solution& solution, std::set<size_t>& blockedVariables) const;
+
+	/**
+	 * @brief Pass the solution of findGreedySolution() to the optimizer as MIP start and report how long it took to find this first incumbent
+	 */
+	template<class OPTIMIZER>
+	void setGreedyStartingPoint(OPTIMIZER& optimizer) const
+	{
+		std::chrono::time_point<std::chrono::high_resolution_clock> start = std::chrono::high_resolution_clock::now();
+		helpers::Solution solution = findGreedySolution();
+		std::chrono::duration<double> greedy_time = std::chrono::high_resolution_clock::now() - start;
+
+		optimizer.setStartingPoint(solution.begin());
+		std::cout << "Greedy starting point has energy: " << model_.evaluate(solution) << std::endl;
+		std::cout << "Time to first incumbent: " << greedy_time.count() << std::endl;
+	}
+
+	/**
+	 * @brief Switch off all tracks that pass through the given detections, i.e. set every variable of their connected components 
+	 *        (along active links and divisions) to zero. If the solution satisfied all constraints except at these detections, 
+	 *        the result is feasible.
+	 */
+	void clearTracksThrough(const std::set<helpers::IdLabelType>& detectionIds, helpers::Solution& solution) const;
+
+	/**
+	 * @brief Turn the labeling of an LP relaxation (the most likely state of each variable) into one that satisfies all constraints
+	 * @details The tracks through detections with fractional variables, and through all remaining violations, are switched off.
+	 *          The integral part that is kept stays fixed, and the greedy constructor adds tracks among the other detections.
+	 * 
+	 * @param relaxedSolution the labeling returned by the LP optimizer
+	 * @param isIntegral for each opengm variable, whether the relaxation assigns it integrally
+	 * @return a labeling that passes verifySolution(), if that fails the greedy solution. Throws if neither is valid
+	 */
+	helpers::Solution roundRelaxedSolution(const helpers::Solution& relaxedSolution, const std::vector<bool>& isIntegral) const;
+
+	/**
+	 * @brief Greedy construction of findGreedySolution(), starting from the given labeling
+	 * 
+	 * @param solution a feasible labeling that is extended
+	 * @param frozenDetections detections whose variables, incoming and outgoing links are not changed
+	 * @return whether the result passes verifySolution()
+	 */
+	bool extendGreedySolution(helpers::Solution& solution, const std::set<helpers::IdLabelType>& frozenDetections) const;
+
+	/**
+	 * @brief Extend a solution of the opengm model by the states of all substituted appearance and disappearance variables
+	 */
+	void reconstructSubstitutedVariables(helpers::Solution& solution) const;
+
 	/**
 	 * @brief deduce states of appearance and disappearance variables and update the solution vector
 	 */
@@ -129,10 +578,15 @@ protected:
 	std::map<DivisionHypothesis::IdType, std::shared_ptr<DivisionHypothesis> > divisionHypotheses_;
 	// exclusion constraints
 	std::vector<ExclusionConstraint> exclusionConstraints_;
+	// exclusion constraints as they are added to the optimization problem by initializeOpenGMModel(), merged into cliques if requested
+	std::vector<ExclusionConstraint> modelExclusionConstraints_;
 
 	// OpenGM stuff
 	helpers::GraphicalModelType model_;
 	double foundSolutionValue_;
+	double foundSolutionBound_ = 0.0;
+	std::chrono::time_point<std::chrono::high_resolution_clock> inferenceStart_;
+	size_t numSubstitutedVariables_ = 0;
 
 	// model settings
 	std::shared_ptr<helpers::Settings> settings_;
@@ -144,6 +598,11 @@ protected:
 	size_t numDisWeights_ = 0;
 	size_t numExternalDivWeights_ = 0;
 	size_t numLinkWeights_ = 0;
+
+	// state of interactive inference, see inferInteractive()
+	std::shared_ptr<CompactFormulation> interactiveFormulation_;
+	std::vector<helpers::ValueType> interactiveWeights_;
+	helpers::Solution interactiveSolution_;
 };
 
 } // end namespace mht
@@ -0,0 +1,78 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <utility>
+
+#include <json/json.h>
+
+namespace mht
+{
+
+/**
+ * @brief A directory of tracking results, stored under a hash of everything that determines them
+ * @details The key combines the canonicalized model (including its settings), the weights and the inference options,
+ *          so identical invocations can skip model construction and solving. Each result is stored as a json file
+ *          with the same layout as JsonModel::saveResultToJson() (including the energy), an index file in the same
+ *          directory keeps the entries in the order they were last used. When the results exceed the size limit,
+ *          the least recently used ones are deleted.
+ */
+class ResultCache
+{
+public:
+	/**
+	 * @param directory an existing directory where the results are stored
+	 * @param maxSizeInBytes maximal total size of all stored results, 0 means no limit
+	 */
+	ResultCache(const std::string& directory, size_t maxSizeInBytes = 0);
+
+	/**
+	 * @brief Compute the key of a tracking result
+	 * @details objects are written with sorted members, so formatting and member order of the model file do not matter
+	 *
+	 * @param model the parsed model, including its settings
+	 * @param weights the weight vector used for inference
+	 * @param options a description of all further options that change the result, e.g. the inference method
+	 * @return a hexadecimal string
+	 */
+	static std::string computeKey(const Json::Value& model, const std::vector<double>& weights, const std::string& options);
+
+	/**
+	 * @brief Look up a result and mark it as most recently used
+	 *
+	 * @param key computed by computeKey()
+	 * @param result will be set to the stored result if there is one
+	 * @return whether the key was found
+	 */
+	bool lookup(const std::string& key, Json::Value& result);
+
+	/**
+	 * @brief Store a result and delete the least recently used ones that exceed the size limit
+	 */
+	void store(const std::string& key, const Json::Value& result);
+
+	/**
+	 * @return the number of results in the cache
+	 */
+	size_t getNumEntries() const { return entries_.size(); }
+
+private:
+	std::string getEntryFilename(const std::string& key) const;
+	std::string getIndexFilename() const;
+	void readIndex();
+	void writeIndex() const;
+	void removeEntry(std::list< std::pair<std::string, size_t> >::iterator entry);
+
+private:
+	std::string directory_;
+	size_t maxSizeInBytes_;
+
+	// keys with the file size of their result, least recently used first
+	std::list< std::pair<std::string, size_t> > entries_;
+};
+
+} // end namespace mht
+
+#endif // RESULT_CACHE_H
@@ -19,6 +19,7 @@ namespace mht
 // forward declaration
 class LinkingHypothesis;
 class DivisionHypothesis;
+class CompactFormulation;
 
 /**
  * @brief A segmentation hypothesis is a detection of a target in a frame.
@@ -41,25 +42,40 @@ public: // API
 
 	const helpers::IdLabelType getId() const { return id_; }
 
+	/**
+	 * @brief Set the number of objects that arrive at this detection along links which are not part of the model,
+	 * 		  e.g. because they were fixed in an earlier step of incremental tracking. They count like active incoming links.
+	 */
+	void setFixedIncomingFlow(size_t flow) { fixedIncomingFlow_ = flow; }
+
+	/**
+	 * @return the number of objects arriving along links which are not part of the model
+	 */
+	size_t getFixedIncomingFlow() const { return fixedIncomingFlow_; }
+
 	/**
 	 * @return detection variable
 	 */
 	const Variable& getDetectionVariable() const { return detection_; }
+	Variable& getDetectionVariable() { return detection_; }
 
 	/**
 	 * @return division variable
 	 */
 	const Variable& getDivisionVariable() const { return division_; }
+	Variable& getDivisionVariable() { return division_; }
 
 	/**
 	 * @return appearance variable
 	 */
 	const Variable& getAppearanceVariable() const { return appearance_; }
+	Variable& getAppearanceVariable() { return appearance_; }
 
 	/**
 	 * @return disappearance variable
 	 */
 	const Variable& getDisappearanceVariable() const { return disappearance_; }
+	Variable& getDisappearanceVariable() { return disappearance_; }
 
 
 	/**
@@ -73,6 +89,10 @@ public: // API
 	 * @param divisionWeightIds indices of the weights that are meant to be used together with the division features
 	 * @param appearanceWeightIds indices of the weights that are meant to be used together with the division features
 	 * @param disappearanceWeightIds indices of the weights that are meant to be used together with the division features
+	 * @param useDivisionConstraint whether to add the division constraint right away
+	 * @param useMergerConstraint whether to add the merger constraints right away
+	 * @param precomputeUnaries store the unary energies computed from the current weights instead of learnable functions
+	 * @param allVariablesBinary set to true if every variable in the model has two states, enables the specialized binary constraint construction
 	 */
 	void addToOpenGMModel(
 		helpers::GraphicalModelType& model, 
@@ -83,9 +103,69 @@ public: // API
 		const std::vector<size_t>& appearanceWeightIds = {},
 		const std::vector<size_t>& disappearanceWeightIds = {},
         bool useDivisionConstraint = true,
-        bool useMergerConstraint = true
+        bool useMergerConstraint = true,
+        bool precomputeUnaries = false,
+        bool allVariablesBinary = false
         );
 
+	/**
+	 * @brief Count the variables, functions and factors (including all constraints) that addToOpenGMModel() would add
+	 * @details Must be kept in sync with addToOpenGMModel()! Parameters are the same as there.
+	 */
+	void countOpenGMModelSize(
+		helpers::OpenGMModelSize& size,
+		std::shared_ptr<helpers::Settings> settings,
+		bool useDivisionConstraint = true,
+		bool useMergerConstraint = true,
+		bool precomputeUnaries = false) const;
+
+	/**
+	 * @brief Decide whether the appearance and disappearance variables can be substituted by the flow conservation constraints, 
+	 *        and if so, fold their energy into the detection, division and link variables.
+	 * @details Must be called before any variable is added to the OpenGM model, and the unaries must be precomputed afterwards.
+	 *        Only variables whose energy is linear in their state and which are not referenced by merger constraints
+	 *        (or, if length one tracks are forbidden, both appearance and disappearance are binary) will be substituted.
+	 * 
+	 * @param weights OpenGM weight object
+	 * @param settings the model settings
+	 * @param appearanceWeightIds indices of the weights that are meant to be used together with the appearance features
+	 * @param disappearanceWeightIds indices of the weights that are meant to be used together with the disappearance features
+	 * @param useMergerConstraint whether merger constraints will be added
+	 * @return the number of substituted variables
+	 */
+	size_t substituteAppearanceDisappearance(
+		const helpers::WeightsType& weights,
+		std::shared_ptr<helpers::Settings> settings,
+		const std::vector<size_t>& appearanceWeightIds,
+		const std::vector<size_t>& disappearanceWeightIds,
+		bool useMergerConstraint = true);
+
+	/**
+	 * @brief Give substituted appearance and disappearance variables consecutive ids after all opengm variables
+	 * 
+	 * @param nextVariableId the next free id, will be increased for each substituted variable
+	 */
+	void assignSubstitutedVariableIds(size_t& nextVariableId);
+
+	/**
+	 * @brief Set the states of the substituted appearance and disappearance variables in the solution from the flow of this detection
+	 */
+	void reconstructSubstitutedStates(helpers::Solution& sol) const;
+
+	/**
+	 * @brief Add the constraints of this hypothesis to the compact integer formulation, 
+	 * where each opengm variable is a single integer column.
+	 * @details The hypothesis must have been added to the OpenGM model before. Parameters are the same as in addToOpenGMModel()
+	 * @param lazyGroup if >= 0, the division and merger constraints are put into this lazy group of the formulation, 
+	 *        such that they are only added once an incumbent violates them
+	 */
+	void addToCompactFormulation(
+		CompactFormulation& formulation,
+		std::shared_ptr<helpers::Settings> settings,
+		bool useDivisionConstraint = true,
+		bool useMergerConstraint = true,
+		int lazyGroup = -1);
+
 	/**
 	 * @brief Add an incoming link to this node as hypothesis. Will be considered in conservation constraints
 	 * @details Links must be added before calling addToOpenGMModel for this segmentation hypothesis!
@@ -130,8 +210,8 @@ public: // API
 	bool verifySolution(const helpers::Solution& sol, const std::shared_ptr<helpers::Settings>& settings) const;
 
 	/**
-	 * @return the number of incoming links and external divisions of this detection which are active in the given solution
-	 * 
+	 * @return the number of incoming links and external divisions of this detection which are active in the given solution,
+	 * 		   plus the fixed incoming flow
 	 */
 	size_t getNumActiveIncomingLinks(const helpers::Solution& sol) const;
 
@@ -148,14 +228,33 @@ public: // API
 private:
 	/**
 	 * @brief Add incoming constraints to OpenGM
+	 * @tparam AllVariablesBinary whether all variables in the model have exactly two states
 	 */
+	template<bool AllVariablesBinary>
 	void addIncomingConstraintToOpenGM(helpers::GraphicalModelType& model);
 
 	/**
 	 * @brief Add outgoing constraints to OpenGM
+	 * @tparam AllVariablesBinary whether all variables in the model have exactly two states
 	 */
+	template<bool AllVariablesBinary>
 	void addOutgoingConstraintToOpenGM(helpers::GraphicalModelType& model);
 
+	/**
+	 * @brief Add the value of the (substituted) appearance, i.e. detection - sum(incoming), to the given linear expression
+	 */
+	void addAppearanceValueTerms(std::map<size_t, double>& coefficients, double coefficient) const;
+
+	/**
+	 * @brief Add the value of the (substituted) disappearance, i.e. detection + division - sum(outgoing), to the given linear expression
+	 */
+	void addDisappearanceValueTerms(std::map<size_t, double>& coefficients, double coefficient) const;
+
+	/**
+	 * @brief Add the constraint that forbids length one tracks if any of appearance and disappearance is substituted
+	 */
+	void addSubstitutedLengthOneConstraintToOpenGM(helpers::GraphicalModelType& model, bool allVariablesBinary);
+
 	/**
 	 * @brief Add division constraints to OpenGM
 	 */
@@ -204,6 +303,8 @@ private:
 	std::vector< std::shared_ptr<LinkingHypothesis> > outgoingLinks_;
 	std::vector< std::shared_ptr<DivisionHypothesis> > incomingDivisions_;
 	std::vector< std::shared_ptr<DivisionHypothesis> > outgoingDivisions_;
+
+	size_t fixedIncomingFlow_ = 0;
 };
 
 template<class T>
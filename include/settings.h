@@ -41,6 +41,17 @@ public: // settings object makes these parameters public instead of writing tons
 	bool optimizerVerbose_; // default = true
 	size_t optimizerNumThreads_; // default = 1, use 0 for all CPU cores
 	bool nonNegativeWeightsOnly_; // default = false
+	bool mergeExclusionCliques_; // default = false
+	bool useCompactFormulation_; // default = false
+	bool substituteAppearanceDisappearance_; // default = false
+	bool useMinCostFlowSolver_; // default = true, used automatically if the model is a pure min cost flow problem
+	bool useGreedyStartingPoint_; // default = true, pass a greedily constructed solution to the ILP solver as MIP start
+	bool useLazyConstraints_; // default = false, cutting constraints are separated by a lazy constraint callback within one solve of the compact formulation
+	bool lazyExclusionConstraints_; // default = false, with cutting constraints, exclusion constraints are only added once a solution violates them
+	bool useDynamicProgramming_; // default = true, solve connected components whose links form a tree exactly by dynamic programming instead of the ILP
+	double optimizerTimeLimit_; // default = 0, wall-clock seconds that inference may take before the best solution found so far is returned, 0 means no limit
+	size_t lookBackHorizon_; // default = 3, number of most recent frames that incremental tracking re-solves
+	bool roundRelaxedSolution_; // default = false, round the solution of the LP relaxation to a labeling that satisfies all constraints
 };
 
 } // end namespace helpers
@@ -0,0 +1,132 @@
+#ifndef TREE_DYNAMIC_PROGRAM_H
+#define TREE_DYNAMIC_PROGRAM_H
+
+#include <vector>
+
+#include "helpers.h"
+
+namespace mht
+{
+
+/**
+ * @brief Exact solver for tracking graphs whose links form a forest (ignoring their direction), e.g. chains of detections
+ * with a few alternatives per frame.
+ * @details Each tree is rooted at an arbitrary detection and processed bottom-up (Viterbi-style): for every state of the link
+ * to its parent, a detection stores the minimal energy of its subtree. The flows on the links of its children are combined
+ * by one knapsack over incoming and one over outgoing links, so the effort is linear in the number of detections and
+ * quadratic in the number of states. The same flow conservation, division, length one and merger constraints as in the ILP are respected.
+ */
+class TreeDynamicProgram
+{
+public:
+	/// which of the constraints of the ILP apply to a detection
+	struct NodeConstraints
+	{
+		/// a division requires the detection to be in state 1
+		bool division = false;
+		/// a division requires two outgoing links in state 1
+		bool separateChildren = false;
+		/// appearance and disappearance may not both be active
+		bool noLengthOneTracks = false;
+		/// an active appearance forbids active incoming links, an active disappearance forbids active outgoing links
+		bool noPartialMergerAppearance = false;
+		/// disappearance and division may not both be active
+		bool noDisappearanceWithDivision = false;
+		/// objects arriving along links that are not part of the dynamic program, they count like active incoming links
+		size_t fixedIncomingFlow = 0;
+	};
+
+	/**
+	 * @brief Add a detection with the energies of all states of its variables, an empty vector means the variable does not exist
+	 * @return the index of the node
+	 */
+	size_t addNode(
+		const std::vector<helpers::ValueType>& detectionEnergies,
+		const std::vector<helpers::ValueType>& appearanceEnergies,
+		const std::vector<helpers::ValueType>& disappearanceEnergies,
+		const std::vector<helpers::ValueType>& divisionEnergies,
+		const NodeConstraints& constraints);
+
+	/**
+	 * @brief Add a link with the energies of all its states
+	 * @return the index of the arc
+	 */
+	size_t addArc(size_t from, size_t to, const std::vector<helpers::ValueType>& energies);
+
+	/**
+	 * @brief Find the optimal states of all variables
+	 * @details throws a std::runtime_error if the arcs contain a cycle or the constraints cannot be satisfied
+	 * @return the minimal energy
+	 */
+	helpers::ValueType solve();
+
+	size_t getDetectionState(size_t node) const { return nodes_[node].states[Detection]; }
+	size_t getAppearanceState(size_t node) const { return nodes_[node].states[Appearance]; }
+	size_t getDisappearanceState(size_t node) const { return nodes_[node].states[Disappearance]; }
+	size_t getDivisionState(size_t node) const { return nodes_[node].states[Division]; }
+	size_t getArcState(size_t arc) const { return arcs_[arc].state; }
+
+	size_t getNumNodes() const { return nodes_.size(); }
+	size_t getNumArcs() const { return arcs_.size(); }
+
+private:
+	enum VariableType {Detection = 0, Appearance, Disappearance, Division, NumVariableTypes};
+
+	/// the choice of a node for one state of its parent arc
+	struct Choice
+	{
+		size_t states[NumVariableTypes];
+		size_t incomingSum;
+		size_t outgoingSum;
+		size_t numOutgoingOnes;
+	};
+
+	struct Node
+	{
+		std::vector<helpers::ValueType> energies[NumVariableTypes];
+		NodeConstraints constraints;
+		std::vector<size_t> arcs;
+
+		// filled during solve()
+		int parentArc = -1;
+		std::vector<size_t> incomingChildArcs;
+		std::vector<size_t> outgoingChildArcs;
+		std::vector<helpers::ValueType> subtreeEnergies;
+		std::vector<Choice> choices;
+		/// flow chosen for each incoming child arc, per knapsack stage and sum
+		std::vector< std::vector<size_t> > incomingFlows;
+		/// flow and previous number of ones chosen for each outgoing child arc, per knapsack stage, sum and number of ones
+		std::vector< std::vector< std::pair<size_t, size_t> > > outgoingFlows;
+		size_t states[NumVariableTypes] = {0, 0, 0, 0};
+	};
+
+	struct Arc
+	{
+		size_t from;
+		size_t to;
+		std::vector<helpers::ValueType> energies;
+		size_t state = 0;
+	};
+
+	/**
+	 * @brief Compute the subtree energy of the node for each state of its parent arc, assuming all children are done
+	 */
+	void solveNode(size_t n);
+
+	/**
+	 * @brief Set the states of the node's variables and the arcs to its children, given the state of its parent arc
+	 */
+	void backtrackNode(size_t n, size_t parentState);
+
+	/// number of states of a variable, variables that do not exist only have state 0
+	static size_t numStates(const std::vector<helpers::ValueType>& energies) { return energies.empty() ? 1 : energies.size(); }
+	static helpers::ValueType energy(const std::vector<helpers::ValueType>& energies, size_t state) { return energies.empty() ? 0.0 : energies[state]; }
+
+private:
+	std::vector<Node> nodes_;
+	std::vector<Arc> arcs_;
+};
+
+} // end namespace mht
+
+#endif // TREE_DYNAMIC_PROGRAM_H
@@ -3,6 +3,8 @@
 
 #include "helpers.h"
 
+#include <stdexcept>
+
 namespace mht
 {
 
@@ -17,7 +19,12 @@ public:
 	 */
 	Variable(const helpers::StateFeatureVector& features = {}):
 		features_(features),
-		openGMVariableId_(-1)
+		openGMVariableId_(-1),
+		openGMUnaryFactorId_(-1),
+		hasExplicitUnary_(false),
+		substituted_(false),
+		constantEnergyOffset_(0.0),
+		energyOffsetPerValue_(0.0)
 	{}
 
 	/**
@@ -27,13 +34,103 @@ public:
 	 * @param statesShareWeights if this is true it means that the features of each state are multiplied by the same weight
 	 * @param weights opengm dataset weight object
 	 * @param weightIds ids into the weight vector that correspond to features
+	 * @param precomputeUnaries if true, the energies are computed once from the current weights and stored as explicit function.
+	 *        Only use this if the weights will not change anymore (e.g. for inference, but not for learning)
 	 * @return the new opengm variable id
 	 */
 	void addToOpenGM(
 		helpers::GraphicalModelType& model, 
 		bool statesShareWeights,
 		helpers::WeightsType& weights, 
-		const std::vector<size_t>& weightIds);
+		const std::vector<size_t>& weightIds,
+		bool precomputeUnaries = false);
+
+	/**
+	 * @brief Add the energy constant + perValue * state to every state of this variable.
+	 * @details Used to fold the energy of substituted variables into the remaining ones. 
+	 *          Only supported if the unaries are precomputed in addToOpenGM().
+	 */
+	void addEnergyOffset(helpers::ValueType constant, helpers::ValueType perValue)
+	{
+		constantEnergyOffset_ += constant;
+		energyOffsetPerValue_ += perValue;
+	}
+
+	/**
+	 * @brief Mark this variable as substituted by the flow conservation constraints, then addToOpenGM() will not add it.
+	 *        Its energy has to be folded into the remaining variables with addEnergyOffset().
+	 */
+	void setSubstituted() { substituted_ = true; }
+
+	/**
+	 * @return whether this variable is not part of the opengm model but determined by the flow conservation constraints
+	 */
+	bool isSubstituted() const { return substituted_; }
+
+	/**
+	 * @brief Give a substituted variable an id after those of all opengm variables, such that its state can still be stored in a solution
+	 */
+	void setSubstitutedVariableId(int id)
+	{
+		if(!substituted_)
+			throw std::runtime_error("Only substituted variables can get an id outside of the opengm model");
+		openGMVariableId_ = id;
+	}
+
+	/**
+	 * @brief Count the variable, function and factor that addToOpenGM() would add
+	 * 
+	 * @param size the counts to increase
+	 * @param statesShareWeights if this is true it means that the features of each state are multiplied by the same weight
+	 * @param precomputeUnaries whether the unary will be stored as explicit function
+	 */
+	void countOpenGMModelSize(helpers::OpenGMModelSize& size, bool statesShareWeights, bool precomputeUnaries) const;
+
+	/**
+	 * @brief Replace the features, which must describe the same number of states
+	 */
+	void setFeatures(const helpers::StateFeatureVector& features)
+	{
+		if(features.size() != features_.size())
+			throw std::runtime_error("Replacing the features of a variable must not change its number of states");
+		features_ = features;
+	}
+
+	/**
+	 * @return whether this variable has any features and will thus be added to opengm
+	 */
+	bool hasFeatures() const { return features_.size() > 0 && features_[0].size() > 0; }
+
+	/**
+	 * @brief Compute the unary energy of every state as dot product of the state's features with the corresponding weights,
+	 *        plus the energy offsets of substituted variables
+	 * 
+	 * @param statesShareWeights if this is true it means that the features of each state are multiplied by the same weight
+	 * @param weights opengm dataset weight object
+	 * @param weightIds ids into the weight vector that correspond to features
+	 * @return a vector containing the energy for each state
+	 */
+	std::vector<helpers::ValueType> computeEnergies(
+		bool statesShareWeights,
+		const helpers::WeightsType& weights, 
+		const std::vector<size_t>& weightIds) const;
+
+	/**
+	 * @brief Evaluate the unary factor that addToOpenGM() has added for this variable at every state
+	 * 
+	 * @param model OpenGM Model this variable was added to
+	 * @return a vector containing the energy for each state, empty if the variable is not part of the model
+	 */
+	std::vector<helpers::ValueType> getOpenGMEnergies(const helpers::GraphicalModelType& model) const;
+
+	/**
+	 * @brief Overwrite the unary that addToOpenGM() has added for this variable, e.g. after its features changed
+	 * @details Only supported if the unaries are precomputed in addToOpenGM(), learnable unaries read the weights themselves
+	 * 
+	 * @param model OpenGM Model this variable was added to
+	 * @param energies the new energy of each state
+	 */
+	void setOpenGMEnergies(helpers::GraphicalModelType& model, const std::vector<helpers::ValueType>& energies) const;
 
 	/**
 	 * @brief Get the number of weights needed for this variable
@@ -73,6 +170,12 @@ public:
 private:
 	helpers::StateFeatureVector features_;
 	int openGMVariableId_;
+	int openGMUnaryFactorId_;
+	bool hasExplicitUnary_;
+	helpers::GraphicalModelType::FunctionIdentifier explicitUnaryFunctionId_;
+	bool substituted_;
+	helpers::ValueType constantEnergyOffset_;
+	helpers::ValueType energyOffsetPerValue_;
 };
 
 }
@@ -31,7 +31,7 @@ object track(object& graphDict, object& weightsDict)
 	
 	PythonModel model;
 	model.readFromPython(pyGraph);
-	FeatureVector weights = readWeightsFromPython(pyWeights);
+	std::vector<ValueType> weights = readWeightsFromPython(pyWeights);
 	Solution solution;
 
 	{
@@ -74,7 +74,7 @@ object trainWithWeightInitialization(object& graphDict, object& gtDict, object&
 	model.readFromPython(pyGraph);
 	model.setPythonGt(pyGt);
 
-	FeatureVector weightInitialization = readWeightsFromPython(pyWeights);
+	std::vector<ValueType> weightInitialization = readWeightsFromPython(pyWeights);
 
 	{
 		// Not sure whether releasing the GIL here is safe,
@@ -432,7 +432,7 @@ helpers::StateFeatureVector PythonModel::extractFeatures(boost::python::dict& en
 
 		for(size_t j = 0; (int)j < len(featuresForState); j++)
 		{
-			featVec.push_back(extract<ValueType>(featuresForState[j]));
+			featVec.push_back(static_cast<FeatureValueType>(extract<ValueType>(featuresForState[j])));
 		}
 
 		// std::cout << "\t\tfound " << featVec.size() << " features for state " << i << std::endl;
@@ -480,10 +480,10 @@ Solution PythonModel::getGroundTruth()
     return solution;
 }
 
-helpers::FeatureVector readWeightsFromPython(boost::python::dict& weightsDict)
+std::vector<helpers::ValueType> readWeightsFromPython(boost::python::dict& weightsDict)
 {
 	list weightsList = extract<list>(weightsDict[JsonTypeNames[JsonTypes::Weights]]);
-	FeatureVector weights;
+	std::vector<ValueType> weights;
 	for(size_t i = 0; (int)i < len(weightsList); i++)
 	{
 		weights.push_back(extract<ValueType>(weightsList[i]));
@@ -20,7 +20,7 @@ namespace mht
  * @param weightsDict
  * @return a vector of weights
  */
-helpers::FeatureVector readWeightsFromPython(boost::python::dict& weightsDict);
+std::vector<helpers::ValueType> readWeightsFromPython(boost::python::dict& weightsDict);
 
 
 /**
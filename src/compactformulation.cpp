@@ -0,0 +1,836 @@
+#include "compactformulation.h"
+#include "settings.h"
+
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <atomic>
+#include <algorithm>
+
+#ifdef WITH_CPLEX
+#include <ilcplex/ilocplex.h>
+#else
+#include <gurobi_c++.h>
+#endif
+
+using namespace helpers;
+
+namespace
+{
+
+#ifdef WITH_CPLEX
+/// adds the rows of all lazy groups that the candidate incumbent violates
+ILOLAZYCONSTRAINTCALLBACK3(LazyRowCallback, const mht::CompactFormulation*, formulation, IloNumVarArray, columns, std::atomic<size_t>*, numLazyRows)
+{
+	IloNumArray values(getEnv());
+	getValues(values, columns);
+	std::vector<double> columnValues(formulation->getNumColumns());
+	for(size_t c = 0; c < columnValues.size(); ++c)
+		columnValues[c] = values[c];
+	values.end();
+
+	for(size_t r : formulation->separateLazyRows(columnValues))
+	{
+		IloExpr expr(getEnv());
+		for(auto& entry : formulation->getRow(r))
+			expr += entry.second * columns[entry.first];
+
+		ValueType bound = formulation->getRowBound(r);
+		switch(formulation->getRowOperator(r))
+		{
+			case mht::CompactFormulation::RowOperator::LessEqual: add(IloRange(getEnv(), -IloInfinity, expr, bound)); break;
+			case mht::CompactFormulation::RowOperator::Equal: add(IloRange(getEnv(), bound, expr, bound)); break;
+			case mht::CompactFormulation::RowOperator::GreaterEqual: add(IloRange(getEnv(), bound, expr, IloInfinity)); break;
+		}
+		expr.end();
+		(*numLazyRows)++;
+	}
+}
+
+/// stops the optimization once the flag is set from another thread
+ILOMIPINFOCALLBACK1(CancelCallback, const std::atomic<bool>*, cancel)
+{
+	if(cancel->load())
+		abort();
+}
+#else
+/// adds the rows of all lazy groups that a new incumbent violates, and stops the optimization once the cancel flag is set
+class LazyRowCallback : public GRBCallback
+{
+public:
+	LazyRowCallback(const mht::CompactFormulation& formulation, const std::vector<GRBVar>& columns, const std::atomic<bool>* cancel):
+		formulation_(formulation),
+		columns_(columns),
+		cancel_(cancel),
+		numLazyRows_(0)
+	{}
+
+	size_t getNumLazyRows() const { return numLazyRows_; }
+	void resetNumLazyRows() { numLazyRows_ = 0; }
+
+protected:
+	void callback()
+	{
+		if(cancel_ != nullptr && cancel_->load())
+		{
+			abort();
+			return;
+		}
+
+		if(where != GRB_CB_MIPSOL || formulation_.getNumLazyGroups() == 0)
+			return;
+
+		double* values = getSolution(columns_.data(), columns_.size());
+		std::vector<double> columnValues(values, values + columns_.size());
+		delete[] values;
+
+		for(size_t r : formulation_.separateLazyRows(columnValues))
+		{
+			GRBLinExpr expr;
+			for(auto& entry : formulation_.getRow(r))
+				expr += entry.second * columns_[entry.first];
+
+			switch(formulation_.getRowOperator(r))
+			{
+				case mht::CompactFormulation::RowOperator::LessEqual: addLazy(expr, GRB_LESS_EQUAL, formulation_.getRowBound(r)); break;
+				case mht::CompactFormulation::RowOperator::Equal: addLazy(expr, GRB_EQUAL, formulation_.getRowBound(r)); break;
+				case mht::CompactFormulation::RowOperator::GreaterEqual: addLazy(expr, GRB_GREATER_EQUAL, formulation_.getRowBound(r)); break;
+			}
+			numLazyRows_++;
+		}
+	}
+
+private:
+	const mht::CompactFormulation& formulation_;
+	const std::vector<GRBVar>& columns_;
+	const std::atomic<bool>* cancel_;
+	size_t numLazyRows_;
+};
+#endif
+
+/// the integer values at which the lower convex envelope of the energies over 0..n-1 has its breakpoints, including both ends
+std::vector<size_t> lowerConvexEnvelope(const std::vector<ValueType>& energies)
+{
+	std::vector<size_t> hull;
+	for(size_t x = 0; x < energies.size(); ++x)
+	{
+		// drop the last point while it does not lie strictly below the segment from its predecessor to x
+		while(hull.size() >= 2)
+		{
+			double a = hull[hull.size() - 2];
+			double b = hull.back();
+			if((energies[hull.back()] - energies[hull[hull.size() - 2]]) * (x - a) >= (energies[x] - energies[hull[hull.size() - 2]]) * (b - a))
+				hull.pop_back();
+			else
+				break;
+		}
+		hull.push_back(x);
+	}
+	return hull;
+}
+
+} // end anonymous namespace
+
+namespace mht
+{
+
+CompactFormulation::CompactFormulation(size_t numVariables):
+	numVariables_(numVariables),
+	columnEnergies_(numVariables, std::vector<ValueType>(1, 0.0)),
+	lazyGroup_(-1)
+{}
+
+void CompactFormulation::setStateEnergies(size_t variable, const std::vector<ValueType>& energies)
+{
+	if(variable >= numVariables_)
+		throw std::runtime_error("Cannot set energies of a column that does not belong to an opengm variable");
+	if(energies.empty())
+		throw std::runtime_error("Each variable needs the energy of at least one state");
+	if(optimizerModel_ && energies.size() != columnEnergies_[variable].size())
+		throw std::runtime_error("The number of states of a column cannot change once resolve() has built the optimizer's model");
+	columnEnergies_[variable] = energies;
+	changedColumns_.insert(variable);
+}
+
+void CompactFormulation::fixColumn(size_t column, size_t value)
+{
+	if(column >= numVariables_ || value > getUpperBound(column))
+		throw std::runtime_error("Cannot fix a column to a value outside of its range");
+	fixedColumns_[column] = value;
+	changedColumns_.insert(column);
+}
+
+void CompactFormulation::unfixColumn(size_t column)
+{
+	fixedColumns_.erase(column);
+	changedColumns_.insert(column);
+}
+
+void CompactFormulation::setStartingPoint(const Solution& labeling)
+{
+	if(!labeling.empty() && labeling.size() != numVariables_)
+		throw std::runtime_error("A starting point needs the state of every opengm variable");
+	startingPoint_ = labeling;
+}
+
+size_t CompactFormulation::getNumFreeRows() const
+{
+	size_t numFreeRows = 0;
+	for(const RowType& row : rows_)
+	{
+		for(auto& entry : row)
+		{
+			if(fixedColumns_.count(entry.first) == 0)
+			{
+				numFreeRows++;
+				break;
+			}
+		}
+	}
+	return numFreeRows;
+}
+
+size_t CompactFormulation::getActivityColumn(size_t column)
+{
+	size_t upperBound = getUpperBound(column);
+	if(upperBound <= 1)
+		return column;
+
+	auto it = activityColumns_.find(column);
+	if(it != activityColumns_.end())
+		return it->second;
+
+	if(optimizerModel_)
+		throw std::runtime_error("Cannot add columns once resolve() has built the optimizer's model");
+	size_t activity = columnEnergies_.size();
+	columnEnergies_.push_back(std::vector<ValueType>(2, 0.0));
+	activityColumns_[column] = activity;
+
+	// activity is 1 if and only if the column takes any value > 0: column <= M * activity, activity <= column
+	int lazyGroup = lazyGroup_;
+	lazyGroup_ = -1;
+	addRow({{column, 1.0}, {activity, -double(upperBound)}}, RowOperator::LessEqual, 0);
+	addRow({{column, 1.0}, {activity, -1.0}}, RowOperator::GreaterEqual, 0);
+	lazyGroup_ = lazyGroup;
+	return activity;
+}
+
+void CompactFormulation::addRow(const RowType& row, RowOperator op, ValueType bound)
+{
+	if(optimizerModel_)
+		throw std::runtime_error("Cannot add rows once resolve() has built the optimizer's model");
+	rows_.push_back(row);
+	rowOperators_.push_back(op);
+	rowBounds_.push_back(bound);
+
+	isLazyRow_.push_back(lazyGroup_ >= 0);
+	if(lazyGroup_ >= 0)
+	{
+		if(lazyGroupRows_.size() <= (size_t)lazyGroup_)
+			lazyGroupRows_.resize(lazyGroup_ + 1);
+		lazyGroupRows_[lazyGroup_].push_back(rows_.size() - 1);
+	}
+}
+
+std::vector<size_t> CompactFormulation::separateLazyRows(const std::vector<double>& columnValues) const
+{
+	std::vector<size_t> violatedRows;
+	for(size_t group = 0; group < lazyGroupRows_.size(); ++group)
+	{
+		bool violated = false;
+		for(size_t r : lazyGroupRows_[group])
+		{
+			double lhs = 0.0;
+			for(auto& entry : rows_[r])
+				lhs += entry.second * columnValues[entry.first];
+
+			// the optimizer's solutions are integral up to its feasibility tolerance
+			switch(rowOperators_[r])
+			{
+				case RowOperator::LessEqual: violated = lhs > rowBounds_[r] + 1e-6; break;
+				case RowOperator::Equal: violated = std::abs(lhs - rowBounds_[r]) > 1e-6; break;
+				case RowOperator::GreaterEqual: violated = lhs < rowBounds_[r] - 1e-6; break;
+			}
+			if(violated)
+				break;
+		}
+
+		// add the complete group, its other rows would probably be violated by the next incumbent otherwise
+		if(violated)
+		{
+			violatedRows.insert(violatedRows.end(), lazyGroupRows_[group].begin(), lazyGroupRows_[group].end());
+		}
+	}
+
+	return violatedRows;
+}
+
+void CompactFormulation::addAtMostOneIfActiveRow(size_t column, size_t gate)
+{
+	size_t upperBound = getUpperBound(column);
+	if(upperBound <= 1)
+		return;
+	addRow({{column, 1.0}, {gate, double(upperBound) - 1.0}}, RowOperator::LessEqual, upperBound);
+}
+
+ValueType CompactFormulation::solveRelaxation(std::shared_ptr<Settings> settings, std::vector<double>& rowDuals) const
+{
+	if(!settings)
+		throw std::runtime_error("Settings object cannot be nullptr");
+
+	rowDuals.assign(rows_.size(), 0.0);
+	ValueType objectiveValue = 0.0;
+
+	auto getBounds = [&](size_t c, double& lower, double& upper) {
+		auto fixed = fixedColumns_.find(c);
+		lower = fixed == fixedColumns_.end() ? 0.0 : fixed->second;
+		upper = fixed == fixedColumns_.end() ? getUpperBound(c) : fixed->second;
+	};
+
+#ifdef WITH_CPLEX
+	IloEnv env;
+	try
+	{
+		IloModel model(env);
+		IloNumVarArray columns(env);
+		IloExpr objective(env);
+		ValueType constant = 0.0;
+
+		for(size_t c = 0; c < columnEnergies_.size(); ++c)
+		{
+			const std::vector<ValueType>& energies = columnEnergies_[c];
+			double lower, upper;
+			getBounds(c, lower, upper);
+			columns.add(IloNumVar(env, lower, upper, ILOFLOAT));
+			constant += energies[0];
+
+			// the convex envelope keeps the relaxation a linear program
+			std::vector<size_t> hull = lowerConvexEnvelope(energies);
+			if(hull.size() == 2)
+				objective += (energies[hull[1]] - energies[0]) / hull[1] * columns[c];
+			else if(hull.size() > 2)
+			{
+				IloNumArray points(env);
+				IloNumArray slopes(env);
+				for(size_t i = 0; i + 1 < hull.size(); ++i)
+				{
+					if(i > 0)
+						points.add(hull[i]);
+					slopes.add((energies[hull[i + 1]] - energies[hull[i]]) / (hull[i + 1] - hull[i]));
+				}
+				objective += IloPiecewiseLinear(columns[c], points, slopes, 0, 0);
+			}
+		}
+		objective += constant;
+		model.add(IloMinimize(env, objective));
+
+		std::vector<IloRange> ranges(rows_.size());
+		for(size_t r = 0; r < rows_.size(); ++r)
+		{
+			if(isLazyRow_[r])
+				continue;
+
+			IloExpr expr(env);
+			for(auto& entry : rows_[r])
+				expr += entry.second * columns[entry.first];
+
+			switch(rowOperators_[r])
+			{
+				case RowOperator::LessEqual: ranges[r] = IloRange(env, -IloInfinity, expr, rowBounds_[r]); break;
+				case RowOperator::Equal: ranges[r] = IloRange(env, rowBounds_[r], expr, rowBounds_[r]); break;
+				case RowOperator::GreaterEqual: ranges[r] = IloRange(env, rowBounds_[r], expr, IloInfinity); break;
+			}
+			model.add(ranges[r]);
+			expr.end();
+		}
+
+		IloCplex cplex(model);
+		cplex.setParam(IloCplex::Threads, settings->optimizerNumThreads_);
+		if(!settings->optimizerVerbose_)
+			cplex.setOut(env.getNullStream());
+		if(!cplex.solve())
+			throw std::runtime_error("CPLEX could not solve the relaxation of the compact formulation");
+
+		objectiveValue = cplex.getObjValue();
+		for(size_t r = 0; r < rows_.size(); ++r)
+			if(!isLazyRow_[r])
+				rowDuals[r] = cplex.getDual(ranges[r]);
+	}
+	catch(IloException& e)
+	{
+		env.end();
+		throw std::runtime_error(std::string("CPLEX error while solving relaxation of compact formulation: ") + e.getMessage());
+	}
+	env.end();
+#else
+	try
+	{
+		GRBEnv env;
+		GRBModel model(env);
+		model.set(GRB_IntParam_OutputFlag, settings->optimizerVerbose_ ? 1 : 0);
+		model.set(GRB_IntParam_Threads, (int)settings->optimizerNumThreads_);
+
+		std::vector<GRBVar> columns;
+		std::vector< std::vector<size_t> > hulls;
+		ValueType constant = 0.0;
+		for(size_t c = 0; c < columnEnergies_.size(); ++c)
+		{
+			const std::vector<ValueType>& energies = columnEnergies_[c];
+			double lower, upper;
+			getBounds(c, lower, upper);
+
+			// the convex envelope keeps the relaxation a linear program
+			hulls.push_back(lowerConvexEnvelope(energies));
+			const std::vector<size_t>& hull = hulls.back();
+			if(hull.size() <= 2)
+			{
+				ValueType cost = hull.size() == 2 ? (energies[hull[1]] - energies[0]) / hull[1] : 0.0;
+				columns.push_back(model.addVar(lower, upper, cost, GRB_CONTINUOUS));
+				constant += energies[0];
+			}
+			else
+				columns.push_back(model.addVar(lower, upper, 0.0, GRB_CONTINUOUS));
+		}
+		model.update();
+
+		for(size_t c = 0; c < columnEnergies_.size(); ++c)
+		{
+			const std::vector<size_t>& hull = hulls[c];
+			if(hull.size() <= 2)
+				continue;
+			std::vector<double> points(hull.begin(), hull.end());
+			std::vector<double> values;
+			for(size_t x : hull)
+				values.push_back(columnEnergies_[c][x]);
+			model.setPWLObj(columns[c], points.size(), points.data(), values.data());
+		}
+		model.set(GRB_DoubleAttr_ObjCon, constant);
+
+		std::vector<GRBConstr> constraints(rows_.size());
+		for(size_t r = 0; r < rows_.size(); ++r)
+		{
+			if(isLazyRow_[r])
+				continue;
+
+			GRBLinExpr expr;
+			for(auto& entry : rows_[r])
+				expr += entry.second * columns[entry.first];
+
+			switch(rowOperators_[r])
+			{
+				case RowOperator::LessEqual: constraints[r] = model.addConstr(expr, GRB_LESS_EQUAL, rowBounds_[r]); break;
+				case RowOperator::Equal: constraints[r] = model.addConstr(expr, GRB_EQUAL, rowBounds_[r]); break;
+				case RowOperator::GreaterEqual: constraints[r] = model.addConstr(expr, GRB_GREATER_EQUAL, rowBounds_[r]); break;
+			}
+		}
+
+		model.optimize();
+		if(model.get(GRB_IntAttr_Status) != GRB_OPTIMAL)
+			throw std::runtime_error("Gurobi could not solve the relaxation of the compact formulation");
+
+		objectiveValue = model.get(GRB_DoubleAttr_ObjVal);
+		for(size_t r = 0; r < rows_.size(); ++r)
+			if(!isLazyRow_[r])
+				rowDuals[r] = constraints[r].get(GRB_DoubleAttr_Pi);
+	}
+	catch(GRBException& e)
+	{
+		throw std::runtime_error("Gurobi error while solving relaxation of compact formulation: " + e.getMessage());
+	}
+#endif
+
+	return objectiveValue;
+}
+
+#ifdef WITH_CPLEX
+/// the model is extracted once, later changes to it are passed on to cplex incrementally
+struct CompactFormulation::OptimizerModel
+{
+	OptimizerModel():
+		numLazyRows(0)
+	{
+		model = IloModel(env);
+		columns = IloNumVarArray(env);
+		objective = IloMinimize(env);
+		model.add(objective);
+	}
+
+	~OptimizerModel() { env.end(); }
+
+	IloEnv env;
+	IloModel model;
+	IloNumVarArray columns;
+	IloObjective objective;
+
+	/// columns with more than two states pay their piecewise linear energy through a continuous cost column,
+	/// whose defining row is replaced when the energies change
+	std::map<size_t, IloNumVar> costColumns;
+	std::map<size_t, IloRange> costRows;
+
+	IloCplex cplex;
+	std::atomic<size_t> numLazyRows;
+};
+#else
+struct CompactFormulation::OptimizerModel
+{
+	OptimizerModel():
+		model(env)
+	{}
+
+	GRBEnv env;
+	GRBModel model;
+	std::vector<GRBVar> columns;
+	std::unique_ptr<LazyRowCallback> callback;
+};
+#endif
+
+Solution CompactFormulation::solve(
+	std::shared_ptr<Settings> settings, 
+	ValueType& energy, 
+	ValueType& bound, 
+	double timeLimit, 
+	const std::atomic<bool>* cancel) const
+{
+	return solveWithEnergies(settings, columnEnergies_, energy, bound, timeLimit, cancel);
+}
+
+Solution CompactFormulation::solve(
+	std::shared_ptr<Settings> settings, 
+	const std::vector< std::vector<ValueType> >& variableEnergies,
+	ValueType& energy, 
+	ValueType& bound, 
+	double timeLimit) const
+{
+	if(variableEnergies.size() != numVariables_)
+		throw std::runtime_error("Need energies for every opengm variable of the compact formulation");
+
+	// auxiliary columns keep their zero energies
+	std::vector< std::vector<ValueType> > columnEnergies(variableEnergies);
+	columnEnergies.insert(columnEnergies.end(), columnEnergies_.begin() + numVariables_, columnEnergies_.end());
+	for(size_t c = 0; c < numVariables_; ++c)
+		if(columnEnergies[c].size() != columnEnergies_[c].size())
+			throw std::runtime_error("Replaced energies must have the same number of states as the formulation");
+
+	return solveWithEnergies(settings, columnEnergies, energy, bound, timeLimit, nullptr);
+}
+
+Solution CompactFormulation::solveWithEnergies(
+	std::shared_ptr<Settings> settings, 
+	const std::vector< std::vector<ValueType> >& columnEnergies,
+	ValueType& energy, 
+	ValueType& bound, 
+	double timeLimit, 
+	const std::atomic<bool>* cancel) const
+{
+	if(!settings)
+		throw std::runtime_error("Settings object cannot be nullptr");
+
+	try
+	{
+		std::shared_ptr<OptimizerModel> optimizerModel = buildOptimizerModel(columnEnergies, cancel);
+		return optimize(*optimizerModel, settings, energy, bound, timeLimit);
+	}
+#ifdef WITH_CPLEX
+	catch(IloException& e)
+	{
+		throw std::runtime_error(std::string("CPLEX error while solving compact formulation: ") + e.getMessage());
+	}
+#else
+	catch(GRBException& e)
+	{
+		throw std::runtime_error("Gurobi error while solving compact formulation: " + e.getMessage());
+	}
+#endif
+}
+
+Solution CompactFormulation::resolve(
+	std::shared_ptr<Settings> settings, 
+	ValueType& energy, 
+	ValueType& bound, 
+	double timeLimit)
+{
+	if(!settings)
+		throw std::runtime_error("Settings object cannot be nullptr");
+
+	try
+	{
+		if(!optimizerModel_)
+			optimizerModel_ = buildOptimizerModel(columnEnergies_, nullptr);
+		else
+		{
+			std::cout << "Updating " << changedColumns_.size() << " columns of the compact formulation" << std::endl;
+			for(size_t c : changedColumns_)
+				setColumn(*optimizerModel_, c, columnEnergies_[c]);
+			setObjectiveConstant(*optimizerModel_, columnEnergies_);
+		}
+		changedColumns_.clear();
+		return optimize(*optimizerModel_, settings, energy, bound, timeLimit);
+	}
+#ifdef WITH_CPLEX
+	catch(IloException& e)
+	{
+		throw std::runtime_error(std::string("CPLEX error while re-solving compact formulation: ") + e.getMessage());
+	}
+#else
+	catch(GRBException& e)
+	{
+		throw std::runtime_error("Gurobi error while re-solving compact formulation: " + e.getMessage());
+	}
+#endif
+}
+
+std::shared_ptr<CompactFormulation::OptimizerModel> CompactFormulation::buildOptimizerModel(
+	const std::vector< std::vector<ValueType> >& columnEnergies,
+	const std::atomic<bool>* cancel) const
+{
+	std::shared_ptr<OptimizerModel> optimizerModel = std::make_shared<OptimizerModel>();
+
+#ifdef WITH_CPLEX
+	IloEnv& env = optimizerModel->env;
+	for(size_t c = 0; c < columnEnergies.size(); ++c)
+	{
+		size_t upperBound = columnEnergies[c].size() - 1;
+		optimizerModel->columns.add(IloNumVar(env, 0, upperBound, upperBound <= 1 ? ILOBOOL : ILOINT));
+	}
+	for(size_t c = 0; c < columnEnergies.size(); ++c)
+		setColumn(*optimizerModel, c, columnEnergies[c]);
+	setObjectiveConstant(*optimizerModel, columnEnergies);
+
+	for(size_t r = 0; r < rows_.size(); ++r)
+	{
+		if(isLazyRow_[r])
+			continue;
+
+		IloExpr expr(env);
+		for(auto& entry : rows_[r])
+			expr += entry.second * optimizerModel->columns[entry.first];
+
+		switch(rowOperators_[r])
+		{
+			case RowOperator::LessEqual: optimizerModel->model.add(IloRange(env, -IloInfinity, expr, rowBounds_[r])); break;
+			case RowOperator::Equal: optimizerModel->model.add(IloRange(env, rowBounds_[r], expr, rowBounds_[r])); break;
+			case RowOperator::GreaterEqual: optimizerModel->model.add(IloRange(env, rowBounds_[r], expr, IloInfinity)); break;
+		}
+		expr.end();
+	}
+
+	optimizerModel->cplex = IloCplex(optimizerModel->model);
+	if(!lazyGroupRows_.empty())
+		optimizerModel->cplex.use(LazyRowCallback(env, this, optimizerModel->columns, &optimizerModel->numLazyRows));
+	if(cancel != nullptr)
+		optimizerModel->cplex.use(CancelCallback(env, cancel));
+#else
+	GRBModel& model = optimizerModel->model;
+	for(size_t c = 0; c < columnEnergies.size(); ++c)
+	{
+		size_t upperBound = columnEnergies[c].size() - 1;
+		optimizerModel->columns.push_back(model.addVar(0.0, upperBound, 0.0, upperBound <= 1 ? GRB_BINARY : GRB_INTEGER));
+	}
+	model.update();
+	for(size_t c = 0; c < columnEnergies.size(); ++c)
+		setColumn(*optimizerModel, c, columnEnergies[c]);
+	setObjectiveConstant(*optimizerModel, columnEnergies);
+
+	for(size_t r = 0; r < rows_.size(); ++r)
+	{
+		if(isLazyRow_[r])
+			continue;
+
+		GRBLinExpr expr;
+		for(auto& entry : rows_[r])
+			expr += entry.second * optimizerModel->columns[entry.first];
+
+		switch(rowOperators_[r])
+		{
+			case RowOperator::LessEqual: model.addConstr(expr, GRB_LESS_EQUAL, rowBounds_[r]); break;
+			case RowOperator::Equal: model.addConstr(expr, GRB_EQUAL, rowBounds_[r]); break;
+			case RowOperator::GreaterEqual: model.addConstr(expr, GRB_GREATER_EQUAL, rowBounds_[r]); break;
+		}
+	}
+
+	optimizerModel->callback.reset(new LazyRowCallback(*this, optimizerModel->columns, cancel));
+	if(!lazyGroupRows_.empty())
+		model.set(GRB_IntParam_LazyConstraints, 1);
+	if(!lazyGroupRows_.empty() || cancel != nullptr)
+		model.setCallback(optimizerModel->callback.get());
+#endif
+
+	return optimizerModel;
+}
+
+void CompactFormulation::setColumn(OptimizerModel& optimizerModel, size_t column, const std::vector<ValueType>& energies) const
+{
+	size_t upperBound = energies.size() - 1;
+	auto fixed = fixedColumns_.find(column);
+	double lower = fixed == fixedColumns_.end() ? 0.0 : fixed->second;
+	double upper = fixed == fixedColumns_.end() ? upperBound : fixed->second;
+
+#ifdef WITH_CPLEX
+	optimizerModel.columns[column].setBounds(lower, upper);
+	if(upperBound <= 1)
+	{
+		optimizerModel.objective.setLinearCoef(optimizerModel.columns[column], upperBound == 1 ? energies[1] - energies[0] : 0.0);
+		return;
+	}
+
+	// breakpoints at the inner integer values, in between the slope is the energy difference of neighboring states
+	IloEnv& env = optimizerModel.env;
+	IloNumArray points(env);
+	IloNumArray slopes(env);
+	for(size_t value = 1; value <= upperBound; ++value)
+	{
+		if(value < upperBound)
+			points.add(value);
+		slopes.add(energies[value] - energies[value - 1]);
+	}
+
+	auto costRow = optimizerModel.costRows.find(column);
+	if(costRow == optimizerModel.costRows.end())
+	{
+		IloNumVar cost(env, -IloInfinity, IloInfinity, ILOFLOAT);
+		optimizerModel.costColumns[column] = cost;
+		optimizerModel.objective.setLinearCoef(cost, 1.0);
+	}
+	else
+	{
+		optimizerModel.model.remove(costRow->second);
+		costRow->second.end();
+	}
+
+	IloExpr expr(env);
+	expr += optimizerModel.costColumns[column];
+	expr -= IloPiecewiseLinear(optimizerModel.columns[column], points, slopes, 0, 0);
+	optimizerModel.costRows[column] = IloRange(env, 0, expr, 0);
+	optimizerModel.model.add(optimizerModel.costRows[column]);
+	expr.end();
+#else
+	GRBVar& var = optimizerModel.columns[column];
+	var.set(GRB_DoubleAttr_LB, lower);
+	var.set(GRB_DoubleAttr_UB, upper);
+	if(upperBound <= 1)
+	{
+		var.set(GRB_DoubleAttr_Obj, upperBound == 1 ? energies[1] - energies[0] : 0.0);
+		return;
+	}
+
+	// the piecewise linear cost interpolates the energies at all integer values, setting it again replaces the previous one
+	std::vector<double> points(energies.size());
+	std::vector<double> values(energies.size());
+	for(size_t value = 0; value <= upperBound; ++value)
+	{
+		points[value] = value;
+		values[value] = energies[value] - energies[0];
+	}
+	optimizerModel.model.setPWLObj(var, points.size(), points.data(), values.data());
+#endif
+}
+
+void CompactFormulation::setObjectiveConstant(OptimizerModel& optimizerModel, const std::vector< std::vector<ValueType> >& columnEnergies) const
+{
+	// the costs of all columns are relative to the energy of their first state
+	ValueType constant = 0.0;
+	for(auto& energies : columnEnergies)
+		constant += energies[0];
+
+#ifdef WITH_CPLEX
+	optimizerModel.objective.setConstant(constant);
+#else
+	optimizerModel.model.set(GRB_DoubleAttr_ObjCon, constant);
+#endif
+}
+
+Solution CompactFormulation::optimize(
+	OptimizerModel& optimizerModel,
+	std::shared_ptr<Settings> settings, 
+	ValueType& energy, 
+	ValueType& bound, 
+	double timeLimit) const
+{
+	Solution solution(numVariables_, 0);
+
+#ifdef WITH_CPLEX
+	std::cout << "Solving compact formulation with cplex" << std::endl;
+	IloEnv& env = optimizerModel.env;
+	IloCplex& cplex = optimizerModel.cplex;
+	IloNumVarArray& columns = optimizerModel.columns;
+
+	// a reused model still knows the starting point of its previous solve
+	if(cplex.getNumMIPStarts() > 0)
+		cplex.deleteMIPStarts(0, cplex.getNumMIPStarts());
+	if(!startingPoint_.empty())
+	{
+		IloNumVarArray startColumns(env);
+		IloNumArray startValues(env);
+		for(size_t i = 0; i < numVariables_; ++i)
+		{
+			startColumns.add(columns[i]);
+			startValues.add(startingPoint_[i]);
+		}
+		for(auto& activity : activityColumns_)
+		{
+			if(activity.first >= numVariables_)
+				continue;
+			startColumns.add(columns[activity.second]);
+			startValues.add(startingPoint_[activity.first] > 0 ? 1 : 0);
+		}
+		cplex.addMIPStart(startColumns, startValues);
+	}
+
+	// 1e75 is cplex' default, i.e. no time limit
+	cplex.setParam(IloCplex::EpGap, settings->optimizerEpGap_);
+	cplex.setParam(IloCplex::Threads, settings->optimizerNumThreads_);
+	cplex.setParam(IloCplex::TiLim, timeLimit < std::numeric_limits<double>::infinity() ? std::max(0.0, timeLimit) : 1e75);
+	cplex.setOut(settings->optimizerVerbose_ ? env.out() : env.getNullStream());
+
+	optimizerModel.numLazyRows = 0;
+	bool solved = cplex.solve();
+	if(!lazyGroupRows_.empty())
+		std::cout << "Added " << optimizerModel.numLazyRows << " lazy rows" << std::endl;
+	if(!solved)
+		throw std::runtime_error("CPLEX did not find a solution of the compact formulation");
+
+	for(size_t i = 0; i < numVariables_; ++i)
+		solution[i] = (LabelType)std::round(cplex.getValue(columns[i]));
+	energy = cplex.getObjValue();
+	bound = cplex.getBestObjValue();
+	if(cplex.getStatus() != IloAlgorithm::Optimal)
+		std::cout << "Time limit reached, returning the best solution found so far" << std::endl;
+#else
+	std::cout << "Solving compact formulation with gurobi" << std::endl;
+	GRBModel& model = optimizerModel.model;
+	std::vector<GRBVar>& columns = optimizerModel.columns;
+	model.set(GRB_IntParam_OutputFlag, settings->optimizerVerbose_ ? 1 : 0);
+	model.set(GRB_DoubleParam_MIPGap, settings->optimizerEpGap_);
+	model.set(GRB_IntParam_Threads, (int)settings->optimizerNumThreads_);
+	model.set(GRB_DoubleParam_TimeLimit, timeLimit < std::numeric_limits<double>::infinity() ? std::max(0.0, timeLimit) : GRB_INFINITY);
+
+	// a reused model still knows the starting point of its previous solve, so it is always overwritten
+	for(size_t i = 0; i < numVariables_; ++i)
+		columns[i].set(GRB_DoubleAttr_Start, startingPoint_.empty() ? GRB_UNDEFINED : startingPoint_[i]);
+	for(auto& activity : activityColumns_)
+	{
+		if(activity.first >= numVariables_)
+			continue;
+		columns[activity.second].set(GRB_DoubleAttr_Start, 
+			startingPoint_.empty() ? GRB_UNDEFINED : (startingPoint_[activity.first] > 0 ? 1.0 : 0.0));
+	}
+
+	optimizerModel.callback->resetNumLazyRows();
+	model.optimize();
+	if(!lazyGroupRows_.empty())
+		std::cout << "Added " << optimizerModel.callback->getNumLazyRows() << " lazy rows" << std::endl;
+	if(model.get(GRB_IntAttr_SolCount) == 0)
+		throw std::runtime_error("Gurobi did not find a solution of the compact formulation");
+
+	for(size_t i = 0; i < numVariables_; ++i)
+		solution[i] = (LabelType)std::round(columns[i].get(GRB_DoubleAttr_X));
+	energy = model.get(GRB_DoubleAttr_ObjVal);
+	bound = model.get(GRB_DoubleAttr_ObjBound);
+	if(model.get(GRB_IntAttr_Status) == GRB_TIME_LIMIT)
+		std::cout << "Time limit reached, returning the best solution found so far" << std::endl;
+#endif
+
+	return solution;
+}
+
+} // end namespace mht
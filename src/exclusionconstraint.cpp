@@ -1,5 +1,7 @@
 #include "exclusionconstraint.h"
+#include "compactformulation.h"
 #include <algorithm>
+#include <set>
 
 using namespace helpers;
 
@@ -10,7 +12,10 @@ ExclusionConstraint::ExclusionConstraint(const std::vector<helpers::IdLabelType>
 	ids_(ids)
 {}
 
-void ExclusionConstraint::addToOpenGMModel(GraphicalModelType& model, std::map<helpers::IdLabelType, SegmentationHypothesis>& segmentationHypotheses)
+void ExclusionConstraint::addToOpenGMModel(
+	GraphicalModelType& model, 
+	std::map<helpers::IdLabelType, SegmentationHypothesis>& segmentationHypotheses,
+	bool allVariablesBinary)
 {
 	LinearConstraintFunctionType::LinearConstraintType exclusionConstraint;
 	std::vector<LabelType> factorVariables;
@@ -24,10 +29,19 @@ void ExclusionConstraint::addToOpenGMModel(GraphicalModelType& model, std::map<h
     // sum of all participating indicator variables for states > 0 must not exceed 1
     for(size_t i = 0; i < ids_.size(); ++i)
     {
+    	size_t opengmVariableId = segmentationHypotheses[ids_[i]].getDetectionVariable().getOpenGMVariableId();
+
+    	// in a binary model only state 1 is active, no need to query the number of labels
+    	if(allVariablesBinary)
+    	{
+	    	addOpenGMVariableToConstraint(exclusionConstraint, opengmVariableId, 1, 1.0, constraintShape, factorVariables, model);
+	    	continue;
+    	}
+
     	// indicator variable references the i'th argument of the constraint function, and its states > 0
-    	for(size_t state = 1; state < model.numberOfLabels(segmentationHypotheses[ids_[i]].getDetectionVariable().getOpenGMVariableId()); ++state)
+    	for(size_t state = 1; state < model.numberOfLabels(opengmVariableId); ++state)
     	{
-	    	addOpenGMVariableToConstraint(exclusionConstraint, segmentationHypotheses[ids_[i]].getDetectionVariable().getOpenGMVariableId(),
+	    	addOpenGMVariableToConstraint(exclusionConstraint, opengmVariableId,
 				state, 1.0, constraintShape, factorVariables, model);
 	    }
     }
@@ -38,6 +52,36 @@ void ExclusionConstraint::addToOpenGMModel(GraphicalModelType& model, std::map<h
     addConstraintToOpenGMModel(exclusionConstraint, constraintShape, factorVariables, model);
 }
 
+void ExclusionConstraint::addToCompactFormulation(
+	CompactFormulation& formulation,
+	const std::map<helpers::IdLabelType, SegmentationHypothesis>& segmentationHypotheses) const
+{
+	CompactFormulation::RowType row;
+	for(size_t i = 0; i < ids_.size(); ++i)
+	{
+		size_t opengmVariableId = segmentationHypotheses.at(ids_[i]).getDetectionVariable().getOpenGMVariableId();
+		row.push_back(std::make_pair(formulation.getActivityColumn(opengmVariableId), 1.0));
+	}
+	formulation.addRow(row, CompactFormulation::RowOperator::LessEqual, 1);
+}
+
+void ExclusionConstraint::countOpenGMModelSize(
+	OpenGMModelSize& size,
+	const std::map<helpers::IdLabelType, SegmentationHypothesis>& segmentationHypotheses,
+	bool allVariablesBinary) const
+{
+	// each active state of each detection appears once in the constraint
+	size_t numConstraintVariables = 0;
+	for(size_t i = 0; i < ids_.size(); ++i)
+	{
+		if(allVariablesBinary)
+			numConstraintVariables++;
+		else
+			numConstraintVariables += segmentationHypotheses.at(ids_[i]).getDetectionVariable().getNumStates() - 1;
+	}
+	size.addConstraint(numConstraintVariables);
+}
+
 bool ExclusionConstraint::verifySolution(const Solution& sol, const std::map<helpers::IdLabelType, SegmentationHypothesis>& segmentationHypotheses) const
 {
 	size_t sum = 0;
@@ -64,4 +108,88 @@ void ExclusionConstraint::toDot(std::ostream& stream) const
 	}
 }
 
+std::vector<ExclusionConstraint> ExclusionConstraint::mergeIntoCliques(const std::vector<ExclusionConstraint>& constraints)
+{
+	typedef std::pair<helpers::IdLabelType, helpers::IdLabelType> EdgeType;
+	std::map<helpers::IdLabelType, std::set<helpers::IdLabelType> > neighbors;
+	std::set<EdgeType> uncoveredEdges;
+
+	auto makeEdge = [](const helpers::IdLabelType& a, const helpers::IdLabelType& b){
+		return a < b ? EdgeType(a, b) : EdgeType(b, a);
+	};
+
+	// every constraint is a clique in the conflict graph, insert all its pairwise edges
+	for(auto iter = constraints.begin(); iter != constraints.end(); ++iter)
+	{
+		const std::vector<helpers::IdLabelType>& ids = iter->getIds();
+		for(size_t i = 0; i < ids.size(); ++i)
+		{
+			for(size_t j = i + 1; j < ids.size(); ++j)
+			{
+				if(ids[i] == ids[j])
+					continue;
+				neighbors[ids[i]].insert(ids[j]);
+				neighbors[ids[j]].insert(ids[i]);
+				uncoveredEdges.insert(makeEdge(ids[i], ids[j]));
+			}
+		}
+	}
+
+	std::vector<ExclusionConstraint> cliques;
+	while(!uncoveredEdges.empty())
+	{
+		// seed the clique with an edge that is not covered yet
+		EdgeType seed = *uncoveredEdges.begin();
+		std::vector<helpers::IdLabelType> clique = {seed.first, seed.second};
+
+		// only common neighbors of all clique members can extend the clique
+		std::vector<helpers::IdLabelType> candidates;
+		const std::set<helpers::IdLabelType>& secondNeighbors = neighbors[seed.second];
+		for(const helpers::IdLabelType& n : neighbors[seed.first])
+		{
+			if(secondNeighbors.count(n) > 0)
+				candidates.push_back(n);
+		}
+
+		while(!candidates.empty())
+		{
+			// prefer the candidate that covers the most new edges, this keeps the number of cliques small
+			size_t bestIndex = 0;
+			size_t bestNumNewEdges = 0;
+			for(size_t c = 0; c < candidates.size(); ++c)
+			{
+				size_t numNewEdges = 0;
+				for(const helpers::IdLabelType& member : clique)
+					numNewEdges += uncoveredEdges.count(makeEdge(member, candidates[c]));
+
+				if(numNewEdges > bestNumNewEdges || c == 0)
+				{
+					bestIndex = c;
+					bestNumNewEdges = numNewEdges;
+				}
+			}
+
+			helpers::IdLabelType next = candidates[bestIndex];
+			clique.push_back(next);
+
+			const std::set<helpers::IdLabelType>& nextNeighbors = neighbors[next];
+			candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](const helpers::IdLabelType& n){
+				return nextNeighbors.count(n) == 0;
+			}), candidates.end());
+		}
+
+		for(size_t i = 0; i < clique.size(); ++i)
+		{
+			for(size_t j = i + 1; j < clique.size(); ++j)
+			{
+				uncoveredEdges.erase(makeEdge(clique[i], clique[j]));
+			}
+		}
+
+		cliques.push_back(ExclusionConstraint(clique));
+	}
+
+	return cliques;
+}
+
 } // end namespace mht
@@ -33,7 +33,18 @@ std::map<JsonTypes, std::string> JsonTypeNames = {
 	{JsonTypes::AllowPartialMergerAppearance, "allowPartialMergerAppearance"},
 	{JsonTypes::AllowLengthOneTracks, "allowLengthOneTracks"},
 	{JsonTypes::RequireSeparateChildrenOfDivision, "requireSeparateChildrenOfDivision"},
-	{JsonTypes::NonNegativeWeightsOnly, "nonNegativeWeightsOnly"}
+	{JsonTypes::NonNegativeWeightsOnly, "nonNegativeWeightsOnly"},
+	{JsonTypes::MergeExclusionCliques, "mergeExclusionCliques"},
+	{JsonTypes::UseCompactFormulation, "useCompactFormulation"},
+	{JsonTypes::SubstituteAppearanceDisappearance, "substituteAppearanceDisappearance"},
+	{JsonTypes::UseMinCostFlowSolver, "useMinCostFlowSolver"},
+	{JsonTypes::UseGreedyStartingPoint, "useGreedyStartingPoint"},
+	{JsonTypes::UseLazyConstraints, "useLazyConstraints"},
+	{JsonTypes::LazyExclusionConstraints, "lazyExclusionConstraints"},
+	{JsonTypes::UseDynamicProgramming, "useDynamicProgramming"},
+	{JsonTypes::OptimizerTimeLimit, "optimizerTimeLimit"},
+	{JsonTypes::LookBackHorizon, "lookBackHorizon"},
+	{JsonTypes::RoundRelaxedSolution, "roundRelaxedSolution"}
 };
 
 void saveWeightsToJson(
@@ -120,7 +131,7 @@ StateFeatureVector extractFeatures(const Json::Value& entry, JsonTypes type)
 
 		for(int j = 0; j < (int)featuresForState.size(); j++)
 		{
-			featVec.push_back(featuresForState[j].asDouble());
+			featVec.push_back(static_cast<FeatureValueType>(featuresForState[j].asDouble()));
 		}
 
 		// std::cout << "\t\tfound " << featVec.size() << " features for state " << i << std::endl;
@@ -178,4 +189,32 @@ void addConstraintToOpenGMModel(
     model.addFactor(linearConstraintFunctionID, factorVariables.begin(), factorVariables.end());
 }
 
+void addValueConstraintToOpenGMModel(
+	const std::map<size_t, double>& coefficients,
+	double bound,
+	LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::ValueType op,
+	GraphicalModelType& model,
+	bool allVariablesBinary)
+{
+	LinearConstraintFunctionType::LinearConstraintType constraint;
+	std::vector<LabelType> factorVariables;
+	std::vector<LabelType> constraintShape;
+
+	for(auto iter = coefficients.begin(); iter != coefficients.end(); ++iter)
+	{
+		if(iter->second == 0.0)
+			continue;
+
+		if(allVariablesBinary)
+			addOpenGMVariableStateToConstraint<true>(constraint, iter->first, iter->second, constraintShape, factorVariables, model);
+		else
+			addOpenGMVariableStateToConstraint(constraint, iter->first, iter->second, constraintShape, factorVariables, model);
+	}
+
+	constraint.setBound(bound);
+	constraint.setConstraintOperator(op);
+
+	addConstraintToOpenGMModel(constraint, constraintShape, factorVariables, model);
+}
+
 } // end namespace mht
@@ -0,0 +1,384 @@
+#include "incrementalmodel.h"
+#include "jsonmodel.h"
+#include "variable.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+
+using namespace helpers;
+
+namespace mht
+{
+
+IncrementalModel::IncrementalModel(std::shared_ptr<Settings> settings):
+	settings_(settings),
+	numLinkWeights_(0),
+	numDetWeights_(0),
+	numDivWeights_(0),
+	numAppWeights_(0),
+	numDisWeights_(0),
+	numExternalDivWeights_(0),
+	lastSolutionValue_(0.0)
+{
+	if(settings_->lookBackHorizon_ == 0)
+		throw std::runtime_error("The look-back horizon of incremental tracking must contain at least one frame");
+}
+
+void IncrementalModel::updateNumWeights(const Json::Value& entry, JsonTypes type, size_t& numWeights)
+{
+	if(!entry.isMember(JsonTypeNames[type]))
+		return;
+	Variable variable(extractFeatures(entry, type));
+	numWeights = std::max(numWeights, (size_t)std::max(0, variable.getNumWeights(settings_->statesShareWeights_)));
+}
+
+void IncrementalModel::appendFrame(const Json::Value& frame)
+{
+	size_t frameIndex = frames_.size();
+	std::set<IdLabelType> frameDetections;
+
+	const Json::Value& segmentationHypotheses = frame[JsonTypeNames[JsonTypes::Segmentations]];
+	for(int i = 0; i < (int)segmentationHypotheses.size(); i++)
+	{
+		const Json::Value& entry = segmentationHypotheses[i];
+		if(!entry.isMember(JsonTypeNames[JsonTypes::Id]) || !entry[JsonTypeNames[JsonTypes::Id]].isLabelType())
+			throw std::runtime_error("JSON entry for SegmentationHytpohesis is invalid");
+		IdLabelType id = entry[JsonTypeNames[JsonTypes::Id]].asLabelType();
+		if(frameOfDetection_.count(id) > 0 || !frameDetections.insert(id).second)
+			throw std::runtime_error("Detection ids must be unique over all frames of incremental tracking");
+
+		updateNumWeights(entry, JsonTypes::Features, numDetWeights_);
+		updateNumWeights(entry, JsonTypes::DivisionFeatures, numDivWeights_);
+		updateNumWeights(entry, JsonTypes::AppearanceFeatures, numAppWeights_);
+		updateNumWeights(entry, JsonTypes::DisappearanceFeatures, numDisWeights_);
+	}
+
+	auto isKnown = [&](IdLabelType id) -> bool {
+		return frameDetections.count(id) > 0 || frameOfDetection_.count(id) > 0;
+	};
+
+	const Json::Value& linkingHypotheses = frame[JsonTypeNames[JsonTypes::Links]];
+	for(int i = 0; i < (int)linkingHypotheses.size(); i++)
+	{
+		const Json::Value& entry = linkingHypotheses[i];
+		if(!isKnown(entry[JsonTypeNames[JsonTypes::SrcId]].asLabelType())
+			|| frameDetections.count(entry[JsonTypeNames[JsonTypes::DestId]].asLabelType()) == 0)
+			throw std::runtime_error("Links of an appended frame must end in this frame and start in this or an earlier one");
+		updateNumWeights(entry, JsonTypes::Features, numLinkWeights_);
+	}
+
+	const Json::Value& divisionHypotheses = frame[JsonTypeNames[JsonTypes::Divisions]];
+	for(int i = 0; i < (int)divisionHypotheses.size(); i++)
+	{
+		const Json::Value& entry = divisionHypotheses[i];
+		const Json::Value& children = entry[JsonTypeNames[JsonTypes::Children]];
+		if(!isKnown(entry[JsonTypeNames[JsonTypes::Parent]].asLabelType()) || children.size() != 2
+			|| frameDetections.count(children[0].asLabelType()) == 0 || frameDetections.count(children[1].asLabelType()) == 0)
+			throw std::runtime_error("Divisions of an appended frame must end in this frame and start in this or an earlier one");
+		updateNumWeights(entry, JsonTypes::Features, numExternalDivWeights_);
+	}
+
+	const Json::Value& exclusions = frame[JsonTypeNames[JsonTypes::Exclusions]];
+	for(int i = 0; i < (int)exclusions.size(); i++)
+		for(int j = 0; j < (int)exclusions[i].size(); j++)
+			if(!isKnown(exclusions[i][j].asLabelType()))
+				throw std::runtime_error("Exclusions of an appended frame may only contain detections of this or an earlier frame");
+
+	if(numDivWeights_ != 0 && numExternalDivWeights_ != 0)
+		throw std::runtime_error("Model cannot contain divisions within detection nodes and externally at the same time!");
+
+	for(IdLabelType id : frameDetections)
+		frameOfDetection_[id] = frameIndex;
+	frames_.push_back(frame);
+}
+
+void IncrementalModel::appendFrameFromJson(const std::string& filename)
+{
+	std::ifstream input(filename.c_str());
+	if(!input.good())
+		throw std::runtime_error("Could not open JSON frame file " + filename);
+
+	Json::Value frame;
+	input >> frame;
+	appendFrame(frame);
+}
+
+size_t IncrementalModel::computeNumWeights() const
+{
+	return numLinkWeights_ + numDetWeights_ + numDivWeights_ + numAppWeights_ + numDisWeights_ + numExternalDivWeights_;
+}
+
+size_t IncrementalModel::getDetectionState(IdLabelType id) const
+{
+	auto iter = detectionStates_.find(id);
+	return iter == detectionStates_.end() ? 0 : iter->second;
+}
+
+Json::Value IncrementalModel::buildWindow(
+	const std::set<IdLabelType>& openDetections,
+	std::map<IdLabelType, size_t>& fixedIncomingFlow) const
+{
+	size_t firstOpenFrame = frames_.size() - std::min(frames_.size(), settings_->lookBackHorizon_);
+	Json::Value window;
+	settings_->saveToJson(window[JsonTypeNames[JsonTypes::Settings]]);
+
+	// detections that share an exclusion with a fixed active detection stay inactive,
+	// the fixed detections are removed from all other exclusions
+	std::set<IdLabelType> inactive;
+	Json::Value& exclusions = window[JsonTypeNames[JsonTypes::Exclusions]];
+	exclusions = Json::Value(Json::arrayValue);
+	for(size_t f = firstOpenFrame; f < frames_.size(); ++f)
+	{
+		const Json::Value& frameExclusions = frames_[f][JsonTypeNames[JsonTypes::Exclusions]];
+		for(int i = 0; i < (int)frameExclusions.size(); i++)
+		{
+			Json::Value openIds(Json::arrayValue);
+			bool excludedByFixed = false;
+			for(int j = 0; j < (int)frameExclusions[i].size(); j++)
+			{
+				IdLabelType id = frameExclusions[i][j].asLabelType();
+				if(openDetections.count(id) > 0)
+					openIds.append(frameExclusions[i][j]);
+				else if(getDetectionState(id) > 0)
+					excludedByFixed = true;
+			}
+
+			if(excludedByFixed)
+				for(int j = 0; j < (int)openIds.size(); j++)
+					inactive.insert(openIds[j].asLabelType());
+			else if(openIds.size() > 1)
+				exclusions.append(openIds);
+		}
+	}
+
+	auto isInWindow = [&](IdLabelType id) -> bool {
+		return openDetections.count(id) > 0 && inactive.count(id) == 0;
+	};
+
+	Json::Value& links = window[JsonTypeNames[JsonTypes::Links]];
+	links = Json::Value(Json::arrayValue);
+	Json::Value& divisions = window[JsonTypeNames[JsonTypes::Divisions]];
+	divisions = Json::Value(Json::arrayValue);
+	for(size_t f = firstOpenFrame; f < frames_.size(); ++f)
+	{
+		const Json::Value& frameLinks = frames_[f][JsonTypeNames[JsonTypes::Links]];
+		for(int i = 0; i < (int)frameLinks.size(); i++)
+		{
+			IdLabelType srcId = frameLinks[i][JsonTypeNames[JsonTypes::SrcId]].asLabelType();
+			IdLabelType destId = frameLinks[i][JsonTypeNames[JsonTypes::DestId]].asLabelType();
+			if(!isInWindow(destId))
+				continue;
+
+			if(openDetections.count(srcId) == 0)
+			{
+				auto state = linkStates_.find(std::make_pair(srcId, destId));
+				if(state != linkStates_.end())
+					fixedIncomingFlow[destId] += state->second;
+			}
+			else if(isInWindow(srcId))
+				links.append(frameLinks[i]);
+		}
+
+		const Json::Value& frameDivisions = frames_[f][JsonTypeNames[JsonTypes::Divisions]];
+		for(int i = 0; i < (int)frameDivisions.size(); i++)
+		{
+			IdLabelType parentId = frameDivisions[i][JsonTypeNames[JsonTypes::Parent]].asLabelType();
+			std::vector<IdLabelType> childrenIds;
+			for(int c = 0; c < (int)frameDivisions[i][JsonTypeNames[JsonTypes::Children]].size(); c++)
+				childrenIds.push_back(frameDivisions[i][JsonTypeNames[JsonTypes::Children]][c].asLabelType());
+			std::sort(childrenIds.begin(), childrenIds.end());
+
+			if(openDetections.count(parentId) == 0)
+			{
+				auto state = externalDivisionStates_.find(std::make_tuple(parentId, childrenIds[0], childrenIds[1]));
+				if(state != externalDivisionStates_.end())
+					for(IdLabelType child : childrenIds)
+						if(isInWindow(child))
+							fixedIncomingFlow[child] += state->second;
+			}
+			else if(isInWindow(parentId) && isInWindow(childrenIds[0]) && isInWindow(childrenIds[1]))
+				divisions.append(frameDivisions[i]);
+		}
+	}
+
+	Json::Value& segmentations = window[JsonTypeNames[JsonTypes::Segmentations]];
+	segmentations = Json::Value(Json::arrayValue);
+	for(size_t f = firstOpenFrame; f < frames_.size(); ++f)
+	{
+		const Json::Value& frameSegmentations = frames_[f][JsonTypeNames[JsonTypes::Segmentations]];
+		for(int i = 0; i < (int)frameSegmentations.size(); i++)
+		{
+			IdLabelType id = frameSegmentations[i][JsonTypeNames[JsonTypes::Id]].asLabelType();
+			if(!isInWindow(id))
+				continue;
+
+			// objects that arrive along fixed links must not be joined by an appearance if mergers cannot partially appear
+			Json::Value entry = frameSegmentations[i];
+			auto flow = fixedIncomingFlow.find(id);
+			if(flow != fixedIncomingFlow.end() && flow->second > 0 && !settings_->allowPartialMergerAppearance_)
+				entry.removeMember(JsonTypeNames[JsonTypes::AppearanceFeatures]);
+			segmentations.append(entry);
+		}
+	}
+
+	return window;
+}
+
+void IncrementalModel::readWindowResult(const Json::Value& result, const std::set<IdLabelType>& openDetections)
+{
+	// reset everything that was open, links and divisions that start in the open frames also end there
+	for(IdLabelType id : openDetections)
+	{
+		detectionStates_.erase(id);
+		divisionStates_.erase(id);
+	}
+	for(auto iter = linkStates_.begin(); iter != linkStates_.end();)
+	{
+		if(openDetections.count(iter->first.first) > 0)
+			iter = linkStates_.erase(iter);
+		else
+			++iter;
+	}
+	for(auto iter = externalDivisionStates_.begin(); iter != externalDivisionStates_.end();)
+	{
+		if(openDetections.count(std::get<0>(iter->first)) > 0)
+			iter = externalDivisionStates_.erase(iter);
+		else
+			++iter;
+	}
+
+	const Json::Value& linkResults = result[JsonTypeNames[JsonTypes::LinkResults]];
+	for(int i = 0; i < (int)linkResults.size(); i++)
+	{
+		const Json::Value& entry = linkResults[i];
+		linkStates_[std::make_pair(entry[JsonTypeNames[JsonTypes::SrcId]].asLabelType(),
+			entry[JsonTypeNames[JsonTypes::DestId]].asLabelType())] = entry[JsonTypeNames[JsonTypes::Value]].asUInt();
+	}
+
+	const Json::Value& divisionResults = result[JsonTypeNames[JsonTypes::DivisionResults]];
+	for(int i = 0; i < (int)divisionResults.size(); i++)
+	{
+		const Json::Value& entry = divisionResults[i];
+		if(!entry[JsonTypeNames[JsonTypes::Value]].asBool())
+			continue;
+
+		if(entry.isMember(JsonTypeNames[JsonTypes::Parent]))
+		{
+			const Json::Value& children = entry[JsonTypeNames[JsonTypes::Children]];
+			std::vector<IdLabelType> childrenIds = {children[0].asLabelType(), children[1].asLabelType()};
+			std::sort(childrenIds.begin(), childrenIds.end());
+			externalDivisionStates_[std::make_tuple(entry[JsonTypeNames[JsonTypes::Parent]].asLabelType(), childrenIds[0], childrenIds[1])] = 1;
+		}
+		else
+			divisionStates_[entry[JsonTypeNames[JsonTypes::Id]].asLabelType()] = 1;
+	}
+
+	const Json::Value& detectionResults = result[JsonTypeNames[JsonTypes::DetectionResults]];
+	for(int i = 0; i < (int)detectionResults.size(); i++)
+	{
+		const Json::Value& entry = detectionResults[i];
+		detectionStates_[entry[JsonTypeNames[JsonTypes::Id]].asLabelType()] = entry[JsonTypeNames[JsonTypes::Value]].asUInt();
+	}
+}
+
+void IncrementalModel::infer(const std::vector<ValueType>& weights)
+{
+	if(weights.size() != computeNumWeights())
+		throw std::runtime_error("Provided length of vector with initial weights has wrong length!");
+	if(frames_.empty())
+		return;
+
+	std::chrono::time_point<std::chrono::high_resolution_clock> start = std::chrono::high_resolution_clock::now();
+
+	size_t firstOpenFrame = frames_.size() - std::min(frames_.size(), settings_->lookBackHorizon_);
+	std::set<IdLabelType> openDetections;
+	for(size_t f = firstOpenFrame; f < frames_.size(); ++f)
+	{
+		const Json::Value& segmentationHypotheses = frames_[f][JsonTypeNames[JsonTypes::Segmentations]];
+		for(int i = 0; i < (int)segmentationHypotheses.size(); i++)
+			openDetections.insert(segmentationHypotheses[i][JsonTypeNames[JsonTypes::Id]].asLabelType());
+	}
+
+	std::map<IdLabelType, size_t> fixedIncomingFlow;
+	Json::Value window = buildWindow(openDetections, fixedIncomingFlow);
+
+	JsonModel windowModel;
+	windowModel.readFromJsonValue(window);
+	windowModel.setNumWeights(numLinkWeights_, numDetWeights_, numDivWeights_, numAppWeights_, numDisWeights_, numExternalDivWeights_);
+	for(auto iter = fixedIncomingFlow.begin(); iter != fixedIncomingFlow.end(); ++iter)
+		if(iter->second > 0)
+			windowModel.setFixedIncomingFlow(iter->first, iter->second);
+
+	Solution solution = windowModel.infer(weights);
+	readWindowResult(windowModel.resultToJson(solution), openDetections);
+	lastSolutionValue_ = windowModel.getLastSolutionValue();
+
+	std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+	std::cout << "Re-solved frames " << firstOpenFrame << " to " << frames_.size() - 1 << " (" << openDetections.size()
+		<< " detections) in " << elapsed.count() << " secs" << std::endl;
+}
+
+Json::Value IncrementalModel::resultToJson() const
+{
+	Json::Value root;
+
+	Json::Value& linksJson = root[JsonTypeNames[JsonTypes::LinkResults]];
+	linksJson = Json::Value(Json::arrayValue);
+	for(auto iter = linkStates_.begin(); iter != linkStates_.end(); ++iter)
+	{
+		if(iter->second == 0)
+			continue;
+		Json::Value val;
+		val[JsonTypeNames[JsonTypes::SrcId]] = Json::Value(iter->first.first);
+		val[JsonTypeNames[JsonTypes::DestId]] = Json::Value(iter->first.second);
+		val[JsonTypeNames[JsonTypes::Value]] = Json::Value((unsigned int)iter->second);
+		linksJson.append(val);
+	}
+
+	Json::Value& divisionsJson = root[JsonTypeNames[JsonTypes::DivisionResults]];
+	divisionsJson = Json::Value(Json::arrayValue);
+	for(auto iter = divisionStates_.begin(); iter != divisionStates_.end(); ++iter)
+	{
+		Json::Value val;
+		val[JsonTypeNames[JsonTypes::Id]] = Json::Value(iter->first);
+		val[JsonTypeNames[JsonTypes::Value]] = Json::Value(iter->second > 0);
+		divisionsJson.append(val);
+	}
+	for(auto iter = externalDivisionStates_.begin(); iter != externalDivisionStates_.end(); ++iter)
+	{
+		Json::Value val;
+		val[JsonTypeNames[JsonTypes::Parent]] = Json::Value(std::get<0>(iter->first));
+		Json::Value& children = val[JsonTypeNames[JsonTypes::Children]];
+		children.append(std::get<1>(iter->first));
+		children.append(std::get<2>(iter->first));
+		val[JsonTypeNames[JsonTypes::Value]] = Json::Value(iter->second == 1);
+		divisionsJson.append(val);
+	}
+
+	Json::Value& detectionsJson = root[JsonTypeNames[JsonTypes::DetectionResults]];
+	detectionsJson = Json::Value(Json::arrayValue);
+	for(auto iter = detectionStates_.begin(); iter != detectionStates_.end(); ++iter)
+	{
+		if(iter->second == 0)
+			continue;
+		Json::Value val;
+		val[JsonTypeNames[JsonTypes::Id]] = Json::Value(iter->first);
+		val[JsonTypeNames[JsonTypes::Value]] = Json::Value((int)iter->second);
+		detectionsJson.append(val);
+	}
+
+	return root;
+}
+
+void IncrementalModel::saveResultToJson(const std::string& filename) const
+{
+	std::ofstream output(filename.c_str());
+	if(!output.good())
+		throw std::runtime_error("Could not open JSON result file for saving: " + filename);
+
+	output << resultToJson() << std::endl;
+}
+
+} // end namespace mht
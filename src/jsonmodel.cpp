@@ -131,6 +131,11 @@ void JsonModel::readFromJson(const std::string& filename)
     Json::Value root;
     input >> root;
 
+    readFromJsonValue(root);
+}
+
+void JsonModel::readFromJsonValue(const Json::Value& root)
+{
     // read settings:
     Json::Value settingsJson;
     if(!root.isMember(JsonTypeNames[JsonTypes::Settings]))
@@ -339,6 +344,11 @@ void JsonModel::saveResultToJson(const std::string& filename, const Solution& so
     if(!output.good())
         throw std::runtime_error("Could not open JSON result file for saving: " + filename);
 
+    output << resultToJson(sol) << std::endl;
+}
+
+Json::Value JsonModel::resultToJson(const Solution& sol) const
+{
     Json::Value root;
 
     // save links
@@ -386,6 +396,58 @@ void JsonModel::saveResultToJson(const std::string& filename, const Solution& so
     // store result energy
     root[JsonTypeNames[JsonTypes::ResultEnergy]] = Json::Value(getLastSolutionValue());
 
+    return root;
+}
+
+void JsonModel::saveFrequenciesToJson(const std::string& filename, const std::vector<double>& frequencies) const
+{
+    std::ofstream output(filename.c_str());
+    if(!output.good())
+        throw std::runtime_error("Could not open JSON frequency file for saving: " + filename);
+    if(frequencies.size() != model_.numberOfVariables())
+        throw std::runtime_error("Need one frequency per opengm variable");
+
+    Json::Value root;
+    auto frequency = [&](const Variable& variable) -> double {
+        return variable.getOpenGMVariableId() >= 0 ? frequencies[variable.getOpenGMVariableId()] : 0.0;
+    };
+
+    Json::Value& linksJson = root[JsonTypeNames[JsonTypes::LinkResults]];
+    for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+    {
+        Json::Value val;
+        val[JsonTypeNames[JsonTypes::SrcId]] = Json::Value(iter->first.first);
+        val[JsonTypeNames[JsonTypes::DestId]] = Json::Value(iter->first.second);
+        val[JsonTypeNames[JsonTypes::Value]] = Json::Value(frequency(iter->second->getVariable()));
+        linksJson.append(val);
+    }
+
+    Json::Value& divisionsJson = root[JsonTypeNames[JsonTypes::DivisionResults]];
+    for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+    {
+        if(iter->second.getDivisionVariable().getOpenGMVariableId() < 0)
+            continue;
+        Json::Value val;
+        val[JsonTypeNames[JsonTypes::Id]] = Json::Value(iter->first);
+        val[JsonTypeNames[JsonTypes::Value]] = Json::Value(frequency(iter->second.getDivisionVariable()));
+        divisionsJson.append(val);
+    }
+    for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+    {
+        Json::Value val = divisionToJson(iter->second, 0);
+        val[JsonTypeNames[JsonTypes::Value]] = Json::Value(frequency(iter->second->getVariable()));
+        divisionsJson.append(val);
+    }
+
+    Json::Value& detectionsJson = root[JsonTypeNames[JsonTypes::DetectionResults]];
+    for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+    {
+        Json::Value val;
+        val[JsonTypeNames[JsonTypes::Id]] = Json::Value(iter->first);
+        val[JsonTypeNames[JsonTypes::Value]] = Json::Value(frequency(iter->second.getDetectionVariable()));
+        detectionsJson.append(val);
+    }
+
     output << root << std::endl;
 }
 
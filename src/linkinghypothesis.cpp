@@ -48,11 +48,12 @@ void LinkingHypothesis::addToOpenGMModel(
     GraphicalModelType& model, 
     WeightsType& weights, 
     bool statesShareWeights,
-    const std::vector<size_t>& weightIds)
+    const std::vector<size_t>& weightIds,
+    bool precomputeUnaries)
 {
     // std::cout << "Adding linking hypothesis between " << srcId_ << " and " << destId_ << " to opengm" << std::endl;
 
-    variable_.addToOpenGM(model, statesShareWeights, weights, weightIds);
+    variable_.addToOpenGM(model, statesShareWeights, weights, weightIds, precomputeUnaries);
 }
 
 } // end namespace mht
@@ -0,0 +1,221 @@
+#include "mincostflow.h"
+
+#include <queue>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+using namespace helpers;
+
+namespace mht
+{
+
+MinCostFlow::MinCostFlow(size_t numNodes, size_t source, size_t sink):
+	outgoingArcs_(numNodes),
+	potentials_(numNodes, 0.0),
+	source_(source),
+	sink_(sink),
+	flowValue_(0)
+{
+	if(source >= numNodes || sink >= numNodes)
+		throw std::runtime_error("Source and sink must be nodes of the flow graph");
+}
+
+size_t MinCostFlow::addArc(size_t from, size_t to, ValueType cost)
+{
+	if(from >= getNumNodes() || to >= getNumNodes())
+		throw std::runtime_error("Cannot add arc between nodes that are not part of the flow graph");
+
+	size_t arc = arcs_.size();
+	arcs_.push_back({to, cost, 1});
+	arcs_.push_back({from, -cost, 0});
+	outgoingArcs_[from].push_back(arc);
+	outgoingArcs_[to].push_back(arc + 1);
+	blocked_.push_back(false);
+	return arc / 2;
+}
+
+void MinCostFlow::initializePotentials()
+{
+	const ValueType infinity = std::numeric_limits<ValueType>::infinity();
+	std::vector<ValueType> distances(getNumNodes(), infinity);
+	distances[source_] = 0.0;
+
+	// Bellman-Ford, if there is still an update after numNodes rounds there must be a negative cycle
+	for(size_t round = 0; round <= getNumNodes(); ++round)
+	{
+		bool updated = false;
+		for(size_t a = 0; a < arcs_.size(); a += 2)
+		{
+			size_t from = arcs_[a + 1].to;
+			if(distances[from] == infinity || arcs_[a].capacity == 0 || blocked_[a / 2])
+				continue;
+
+			ValueType distance = distances[from] + arcs_[a].cost;
+			if(distance < distances[arcs_[a].to])
+			{
+				distances[arcs_[a].to] = distance;
+				updated = true;
+			}
+		}
+
+		if(!updated)
+			break;
+		if(round == getNumNodes())
+			throw std::runtime_error("Min cost flow graph contains a negative cycle");
+	}
+
+	// nodes that cannot be reached from the source will never be part of an augmenting path
+	for(size_t n = 0; n < getNumNodes(); ++n)
+		potentials_[n] = distances[n] == infinity ? 0.0 : distances[n];
+}
+
+bool MinCostFlow::findShortestPath(std::vector<size_t>& predecessorArcs, ValueType& pathCost)
+{
+	const ValueType infinity = std::numeric_limits<ValueType>::infinity();
+	std::vector<ValueType> distances(getNumNodes(), infinity);
+	predecessorArcs.assign(getNumNodes(), arcs_.size());
+
+	typedef std::pair<ValueType, size_t> QueueEntry;
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > queue;
+	distances[source_] = 0.0;
+	queue.push(std::make_pair(0.0, source_));
+
+	while(!queue.empty())
+	{
+		QueueEntry entry = queue.top();
+		queue.pop();
+		size_t node = entry.second;
+		if(entry.first > distances[node])
+			continue;
+
+		for(size_t a : outgoingArcs_[node])
+		{
+			const Arc& arc = arcs_[a];
+			if(arc.capacity == 0 || blocked_[a / 2])
+				continue;
+
+			// reduced costs are non-negative up to rounding errors
+			ValueType reducedCost = std::max(0.0, arc.cost + potentials_[node] - potentials_[arc.to]);
+			ValueType distance = distances[node] + reducedCost;
+			if(distance < distances[arc.to])
+			{
+				distances[arc.to] = distance;
+				predecessorArcs[arc.to] = a;
+				queue.push(std::make_pair(distance, arc.to));
+			}
+		}
+	}
+
+	if(distances[sink_] == infinity)
+		return false;
+
+	pathCost = distances[sink_] + potentials_[sink_] - potentials_[source_];
+
+	// capping the distances at the one of the sink keeps all reduced costs non-negative
+	for(size_t n = 0; n < getNumNodes(); ++n)
+		potentials_[n] += std::min(distances[n], distances[sink_]);
+
+	return true;
+}
+
+bool MinCostFlow::findCheapestPath(size_t from, size_t to, std::vector<size_t>& path, ValueType& pathCost) const
+{
+	const ValueType infinity = std::numeric_limits<ValueType>::infinity();
+	std::vector<ValueType> distances(getNumNodes(), infinity);
+	std::vector<size_t> predecessorArcs(getNumNodes(), arcs_.size());
+	std::vector<size_t> numUpdates(getNumNodes(), 0);
+	std::vector<bool> isQueued(getNumNodes(), false);
+
+	// queue based Bellman-Ford, a node that is updated more than numNodes times lies on a negative cycle
+	std::queue<size_t> queue;
+	distances[from] = 0.0;
+	queue.push(from);
+	isQueued[from] = true;
+
+	while(!queue.empty())
+	{
+		size_t node = queue.front();
+		queue.pop();
+		isQueued[node] = false;
+
+		for(size_t a : outgoingArcs_[node])
+		{
+			const Arc& arc = arcs_[a];
+			if(arc.capacity == 0 || blocked_[a / 2])
+				continue;
+
+			ValueType distance = distances[node] + arc.cost;
+			if(distance < distances[arc.to] - 1e-12)
+			{
+				distances[arc.to] = distance;
+				predecessorArcs[arc.to] = a;
+				if(++numUpdates[arc.to] > getNumNodes())
+					return false;
+				if(!isQueued[arc.to])
+				{
+					queue.push(arc.to);
+					isQueued[arc.to] = true;
+				}
+			}
+		}
+	}
+
+	if(distances[to] == infinity)
+		return false;
+
+	path.clear();
+	for(size_t node = to; node != from; node = arcs_[predecessorArcs[node] ^ 1].to)
+		path.push_back(predecessorArcs[node]);
+	std::reverse(path.begin(), path.end());
+	pathCost = distances[to];
+	return true;
+}
+
+void MinCostFlow::augmentPath(const std::vector<size_t>& path, bool cancel)
+{
+	for(size_t a : path)
+	{
+		size_t residualArc = cancel ? a ^ 1 : a;
+		if(arcs_[residualArc].capacity == 0)
+			throw std::runtime_error("Cannot send flow along an arc without free capacity");
+		arcs_[residualArc].capacity -= 1;
+		arcs_[residualArc ^ 1].capacity += 1;
+	}
+
+	// keep track of the flow value if the path connects source and sink
+	if(!path.empty() && arcs_[path.front() ^ 1].to == source_ && arcs_[path.back()].to == sink_)
+	{
+		if(cancel)
+			flowValue_--;
+		else
+			flowValue_++;
+	}
+}
+
+ValueType MinCostFlow::solve()
+{
+	flowValue_ = 0;
+	initializePotentials();
+
+	ValueType totalCost = 0.0;
+	std::vector<size_t> predecessorArcs;
+	ValueType pathCost = 0.0;
+
+	// the cost of the cheapest augmenting path is non-decreasing, so stop as soon as sending more flow does not pay off
+	while(findShortestPath(predecessorArcs, pathCost) && pathCost < -1e-9)
+	{
+		for(size_t node = sink_; node != source_; node = arcs_[predecessorArcs[node] ^ 1].to)
+		{
+			arcs_[predecessorArcs[node]].capacity -= 1;
+			arcs_[predecessorArcs[node] ^ 1].capacity += 1;
+		}
+
+		totalCost += pathCost;
+		flowValue_++;
+	}
+
+	return totalCost;
+}
+
+} // end namespace mht
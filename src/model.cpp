@@ -1,9 +1,19 @@
 #include "model.h"
+#include "compactformulation.h"
+#include "mincostflow.h"
 #include <fstream>
 #include <stdexcept>
 #include <numeric>
+#include <limits>
+#include <cmath>
 #include <sstream>
 #include <chrono>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <exception>
 
 // include the LPDef symbols only once!
 #undef OPENGM_LPDEF_NO_SYMBOLS
@@ -24,6 +34,37 @@ using namespace helpers;
 namespace mht
 {
 
+namespace
+{
+
+#ifdef WITH_CPLEX
+typedef opengm::LPCplex2<GraphicalModelType, opengm::Minimizer> OptimizerType;
+#else
+typedef opengm::LPGurobi2<GraphicalModelType, opengm::Minimizer> OptimizerType;
+#endif
+
+/**
+ * @brief Parameters of the ILP optimizer shared by all inference methods that hand the opengm model to it, without time limit
+ */
+OptimizerType::Parameter makeOptimizerParameter(const Settings& settings, bool withIntegerConstraints)
+{
+#ifdef WITH_CPLEX
+	std::cout << "Using cplex optimizer" << std::endl;
+#else
+	std::cout << "Using gurobi optimizer" << std::endl;
+#endif
+	OptimizerType::Parameter optimizerParam;
+	optimizerParam.relaxation_ = OptimizerType::Parameter::TightPolytope;
+	optimizerParam.verbose_ = settings.optimizerVerbose_;
+	optimizerParam.useSoftConstraints_ = false;
+	optimizerParam.integerConstraintNodeVar_ = withIntegerConstraints;
+	optimizerParam.epGap_ = settings.optimizerEpGap_;
+	optimizerParam.numberOfThreads_ = settings.optimizerNumThreads_;
+	return optimizerParam;
+}
+
+} // end anonymous namespace
+
 size_t Model::computeNumWeights()
 {
 	// only compute if it wasn't initialized yet
@@ -89,22 +130,115 @@ size_t Model::computeNumWeights()
 	return numDetWeights_ + numDivWeights_ + numAppWeights_ + numDisWeights_ + numExternalDivWeights_ + numLinkWeights_;
 }
 
-void Model::initializeOpenGMModel(WeightsType& weights, bool withDivisionConstraints, bool withMergerConstrains)
+void Model::setNumWeights(size_t numLinkWeights, size_t numDetWeights, size_t numDivWeights, 
+	size_t numAppWeights, size_t numDisWeights, size_t numExternalDivWeights)
+{
+	numLinkWeights_ = numLinkWeights;
+	numDetWeights_ = numDetWeights;
+	numDivWeights_ = numDivWeights;
+	numAppWeights_ = numAppWeights;
+	numDisWeights_ = numDisWeights;
+	numExternalDivWeights_ = numExternalDivWeights;
+}
+
+void Model::setFixedIncomingFlow(helpers::IdLabelType id, size_t flow)
+{
+	auto iter = segmentationHypotheses_.find(id);
+	if(iter == segmentationHypotheses_.end())
+		throw std::runtime_error("Cannot set fixed incoming flow of a detection that is not part of the model");
+	iter->second.setFixedIncomingFlow(flow);
+}
+
+void Model::forEachVariable(const std::function<void(const Variable&)>& function) const
+{
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+		function(iter->second->getVariable());
+
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+		function(iter->second->getVariable());
+
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		function(iter->second.getDetectionVariable());
+		function(iter->second.getDivisionVariable());
+		function(iter->second.getAppearanceVariable());
+		function(iter->second.getDisappearanceVariable());
+	}
+}
+
+bool Model::hasOnlyBinaryVariables() const
+{
+	// variables without features are not added to opengm and thus do not count
+	bool allBinary = true;
+	forEachVariable([&](const Variable& var){
+		if(var.getNumStates() > 0 && var.getNumStates() != 2)
+			allBinary = false;
+	});
+	return allBinary;
+}
+
+OpenGMModelSize Model::countOpenGMModelSize(
+	bool withDivisionConstraints, 
+	bool withMergerConstrains, 
+	bool precomputeUnaries, 
+	bool allVariablesBinary, 
+	bool withExclusionConstraints) const
+{
+	OpenGMModelSize size;
+
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+		iter->second->countOpenGMModelSize(size, settings_->statesShareWeights_, precomputeUnaries);
+
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+		iter->second->countOpenGMModelSize(size, settings_->statesShareWeights_, precomputeUnaries);
+
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+		iter->second.countOpenGMModelSize(size, settings_, withDivisionConstraints, withMergerConstrains, precomputeUnaries);
+
+	if(withExclusionConstraints)
+	{
+		for(auto iter = modelExclusionConstraints_.begin(); iter != modelExclusionConstraints_.end() ; ++iter)
+			iter->countOpenGMModelSize(size, segmentationHypotheses_, allVariablesBinary);
+	}
+
+	return size;
+}
+
+void Model::initializeOpenGMModel(
+	WeightsType& weights, 
+	bool withDivisionConstraints, 
+	bool withMergerConstrains, 
+	bool precomputeUnaries, 
+	bool substituteAppearanceDisappearance,
+	bool withExclusionConstraints)
 {
 	// make sure the numbers of features are initialized
 	computeNumWeights();
 
-	std::cout << "Initializing opengm model..." << std::endl;
-	// we need two sets of weights for all features to represent state "on" and "off"!
-	std::vector<size_t> linkWeightIds(numLinkWeights_);
-	std::iota(linkWeightIds.begin(), linkWeightIds.end(), 0); // fill with increasing values starting at 0
+	std::cout << "Initializing opengm model" << (precomputeUnaries ? " with precomputed unaries" : "") << "..." << std::endl;
 
-	// first add all link variables, because segmentations will use them when defining constraints
-	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+	// the interactive formulation refers to the variables of the previous opengm model
+	interactiveFormulation_.reset();
+
+	// replace the (mostly pairwise) exclusion constraints by clique constraints that give a tighter relaxation with fewer rows.
+	// Only the optimization problem uses the cliques, the constraints of the input stay as they are
+	modelExclusionConstraints_ = exclusionConstraints_;
+	if(settings_->mergeExclusionCliques_ && !exclusionConstraints_.empty())
 	{
-		iter->second->addToOpenGMModel(model_, weights, settings_->statesShareWeights_, linkWeightIds);
+		modelExclusionConstraints_ = ExclusionConstraint::mergeIntoCliques(exclusionConstraints_);
+		std::cout << "Merged " << exclusionConstraints_.size() << " exclusion constraints into " 
+			<< modelExclusionConstraints_.size() << " clique constraints" << std::endl;
 	}
 
+	// use the specialized constraint construction if there are no multi-state variables
+	bool allVariablesBinary = hasOnlyBinaryVariables();
+	if(allVariablesBinary)
+		std::cout << "All variables are binary" << std::endl;
+
+	// we need two sets of weights for all features to represent state "on" and "off"!
+	std::vector<size_t> linkWeightIds(numLinkWeights_);
+	std::iota(linkWeightIds.begin(), linkWeightIds.end(), 0); // fill with increasing values starting at 0
+
 	std::vector<size_t> detWeightIds(numDetWeights_);
 	std::iota(detWeightIds.begin(), detWeightIds.end(), numLinkWeights_); // fill with increasing values starting at the next valid index
 
@@ -120,9 +254,41 @@ void Model::initializeOpenGMModel(WeightsType& weights, bool withDivisionConstra
 	std::vector<size_t> externalDivWeightIds(numExternalDivWeights_);
 	std::iota(externalDivWeightIds.begin(), externalDivWeightIds.end(), numLinkWeights_ + numDetWeights_ + numDivWeights_ + numAppWeights_ + numDisWeights_);
 
+	// substitution moves energies between variables, so it has to happen before any unary is computed
+	numSubstitutedVariables_ = 0;
+	if(substituteAppearanceDisappearance)
+	{
+		if(!precomputeUnaries)
+			throw std::runtime_error("Substituting appearance and disappearance variables requires precomputed unaries");
+
+		for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+		{
+			numSubstitutedVariables_ += iter->second.substituteAppearanceDisappearance(weights, settings_, appWeightIds, disWeightIds, withMergerConstrains);
+		}
+		std::cout << "Substituted " << numSubstitutedVariables_ << " appearance and disappearance variables" << std::endl;
+	}
+
+	// reserve memory up front instead of letting opengm grow its containers one factor at a time
+	OpenGMModelSize modelSize = countOpenGMModelSize(withDivisionConstraints, withMergerConstrains, precomputeUnaries, allVariablesBinary, withExclusionConstraints);
+	std::cout << "Reserving space for " << modelSize.numVariables << " variables, " 
+		<< modelSize.numFactors() << " factors (" << modelSize.numConstraints << " constraints) and " 
+		<< modelSize.numFactorVariables << " factor variable indices" << std::endl;
+	model_.reserveFactors(modelSize.numFactors());
+	model_.reserveFactorsVarialbeIndices(modelSize.numFactorVariables);
+	model_.reserveFunctions<LearnableUnaryFuncType>(modelSize.numLearnableUnaries);
+	model_.reserveFunctions<LearnableWeightedSumOfFuncType>(modelSize.numLearnableWeightedSums);
+	model_.reserveFunctions<ExplicitFunctionType>(modelSize.numExplicitUnaries);
+	model_.reserveFunctions<LinearConstraintFunctionType>(modelSize.numConstraints);
+
+	// first add all link variables, because segmentations will use them when defining constraints
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+	{
+		iter->second->addToOpenGMModel(model_, weights, settings_->statesShareWeights_, linkWeightIds, precomputeUnaries);
+	}
+
 	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
 	{
-		iter->second->addToOpenGMModel(model_, weights, settings_->statesShareWeights_, externalDivWeightIds);
+		iter->second->addToOpenGMModel(model_, weights, settings_->statesShareWeights_, externalDivWeightIds, precomputeUnaries);
 	}
 
     if(withDivisionConstraints)
@@ -137,69 +303,93 @@ void Model::initializeOpenGMModel(WeightsType& weights, bool withDivisionConstra
 
 	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
 	{
-		iter->second.addToOpenGMModel(model_, weights, settings_, detWeightIds, divWeightIds, appWeightIds, disWeightIds, withDivisionConstraints, withMergerConstrains);
+		iter->second.addToOpenGMModel(model_, weights, settings_, detWeightIds, divWeightIds, appWeightIds, disWeightIds, 
+			withDivisionConstraints, withMergerConstrains, precomputeUnaries, allVariablesBinary);
 	}
 
-	for(auto iter = exclusionConstraints_.begin(); iter != exclusionConstraints_.end() ; ++iter)
+	if(withExclusionConstraints)
+	{
+		for(auto iter = modelExclusionConstraints_.begin(); iter != modelExclusionConstraints_.end() ; ++iter)
+		{
+			iter->addToOpenGMModel(model_, segmentationHypotheses_, allVariablesBinary);
+		}
+	}
+	else
+		std::cout << "No exclusion constraints used" << std::endl;
+
+	// substituted variables get ids after all opengm variables, such that solutions can store their state
+	size_t nextVariableId = model_.numberOfVariables();
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
 	{
-		iter->addToOpenGMModel(model_, segmentationHypotheses_);
+		iter->second.assignSubstitutedVariableIds(nextVariableId);
 	}
 
-	size_t numIndicatorVars = 0;
-	for(size_t i = 0; i < model_.numberOfVariables(); i++)
+	size_t numIndicatorVars = 2 * model_.numberOfVariables();
+	if(!allVariablesBinary)
 	{
-		numIndicatorVars += model_.numberOfLabels(i);
+		numIndicatorVars = 0;
+		for(size_t i = 0; i < model_.numberOfVariables(); i++)
+		{
+			numIndicatorVars += model_.numberOfLabels(i);
+		}
 	}
 	std::cout << "Model has " << numIndicatorVars << " indicator variables" << std::endl;
+
+	if(model_.numberOfVariables() != modelSize.numVariables || model_.numberOfFactors() != modelSize.numFactors())
+		std::cout << "WARNING: expected " << modelSize.numVariables << " variables and " << modelSize.numFactors() << " factors, but model has "
+			<< model_.numberOfVariables() << " variables and " << model_.numberOfFactors() << " factors" << std::endl;
 }
 
 Solution Model::inferWithCuttingConstraints(const std::vector<ValueType>& weights, bool withIntegerConstraints)
 {
     std::cout << "Infer with Cutting Constraints..." << std::endl;
     std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+    inferenceStart_ = std::chrono::high_resolution_clock::now();
 
 	// use weights that were given
-	WeightsType weightObject(computeNumWeights());
-	assert(weights.size() == weightObject.numberOfWeights());
-	if(weights.size() != weightObject.numberOfWeights())
-	{
-		std::cout << "Provided length of vector with initial weights has wrong length!" << std::endl;
-		throw std::runtime_error("Provided length of vector with initial weights has wrong length!");
-	}
-	for(size_t i = 0; i < weights.size(); i++)
-		weightObject.setWeight(i, weights[i]);
+	WeightsType weightObject = makeWeightObject(weights);
 
 
+    // weights are fixed during inference, so the unaries can be evaluated once up front
     start = std::chrono::high_resolution_clock::now();
-    initializeOpenGMModel(weightObject, false, false);
+    bool lazyExclusions = settings_->lazyExclusionConstraints_;
+    initializeOpenGMModel(weightObject, false, false, true, false, !lazyExclusions);
     end = std::chrono::high_resolution_clock::now();
 
     std::chrono::duration<double> model_time = end - start;
     std::cout << "Model initialization time: " << model_time.count() << std::endl;
 
+    // instead of re-solving from scratch, let the optimizer add violated division and merger constraints during a single solve
+    if(withIntegerConstraints && settings_->useLazyConstraints_)
+    {
+        start = std::chrono::high_resolution_clock::now();
+        Solution solution = inferCompactFormulation(true, true, true, lazyExclusions);
+        end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> solve_time = end - start;
+
+        std::cout << "solution has energy: " << foundSolutionValue_ << std::endl;
+        printBoundAndGap();
+        std::cout << "Solving time: " << solve_time.count() << std::endl;
+        return solution;
+    }
 
-#ifdef WITH_CPLEX
-    std::cout << "Using cplex optimizer" << std::endl;
-    typedef opengm::LPCplex2<GraphicalModelType, opengm::Minimizer> OptimizerType;
-#else
-    std::cout << "Using gurobi optimizer" << std::endl;
-    typedef opengm::LPGurobi2<GraphicalModelType, opengm::Minimizer> OptimizerType;
-#endif
-    OptimizerType::Parameter optimizerParam;
-    optimizerParam.relaxation_ = OptimizerType::Parameter::TightPolytope;
-    optimizerParam.verbose_ = settings_->optimizerVerbose_;
-    optimizerParam.useSoftConstraints_ = false;
-    optimizerParam.integerConstraintNodeVar_ = withIntegerConstraints;
-    optimizerParam.epGap_ = settings_->optimizerEpGap_;
-    optimizerParam.numberOfThreads_ = settings_->optimizerNumThreads_;
 
+    OptimizerType::Parameter optimizerParam = makeOptimizerParameter(*settings_, withIntegerConstraints);
 
-    std::set<int> divisionIDs = {};
-    std::set<int> newDivisionIDs = {};
+
+    std::set<helpers::IdLabelType> divisionIDs = {};
+    std::set<helpers::IdLabelType> newDivisionIDs = {};
+
+    // exclusion constraints that are part of the model, all of them unless they are added lazily
+    bool allVariablesBinary = hasOnlyBinaryVariables();
+    std::vector<bool> isExclusionAdded(modelExclusionConstraints_.size(), !lazyExclusions);
+    std::vector<size_t> newExclusions;
     unsigned int iterCount = 0;
     unsigned int divCount = 0;
     unsigned int divCountNew = 0;
     bool valid = false;
+    bool previousSolutionIsInteger = false;
+    bool timeIsUp = false;
     Solution solution(model_.numberOfVariables());
 
     std::chrono::duration<double> total_solve_time(0);
@@ -222,11 +412,40 @@ Solution Model::inferWithCuttingConstraints(const std::vector<ValueType>& weight
         }
         std::cout << std::endl;
 
+        if(lazyExclusions)
+        {
+            std::cout << "Add " << newExclusions.size() << " violated exclusion constraints" << std::endl;
+            for(size_t e : newExclusions)
+                modelExclusionConstraints_[e].addToOpenGMModel(model_, segmentationHypotheses_, allVariablesBinary);
+        }
+
+
+        // the time limit spans all iterations, so each solve only gets what is left
+        if(settings_->optimizerTimeLimit_ > 0.0)
+            optimizerParam.timeLimit_ = getRemainingTime();
 
         OptimizerType optimizer(model_, optimizerParam);
         OptimizerType::VerboseVisitorType optimizerVisitor;
 
-        // optimizer.setStartingPoint(solution);
+        // the previous integer solution only violates the constraints that were just added, so it is a good start once repaired
+        if(withIntegerConstraints && previousSolutionIsInteger)
+        {
+            // the detections of newly added exclusions have to be switched off as well
+            std::set<helpers::IdLabelType> violatedIDs(newDivisionIDs);
+            for(size_t e : newExclusions)
+            {
+                for(helpers::IdLabelType id : modelExclusionConstraints_[e].getIds())
+                    if(solution[segmentationHypotheses_[id].getDetectionVariable().getOpenGMVariableId()] > 0)
+                        violatedIDs.insert(id);
+            }
+
+            Solution startingPoint(solution);
+            clearTracksThrough(violatedIDs, startingPoint);
+            optimizer.setStartingPoint(startingPoint.begin());
+            std::cout << "Repaired previous solution has energy: " << model_.evaluate(startingPoint) << std::endl;
+        }
+        else if(withIntegerConstraints && settings_->useGreedyStartingPoint_)
+            setGreedyStartingPoint(optimizer);
 
         start = std::chrono::high_resolution_clock::now();
         optimizer.infer(optimizerVisitor);
@@ -235,8 +454,12 @@ Solution Model::inferWithCuttingConstraints(const std::vector<ValueType>& weight
         total_solve_time += solve_time;
 
         optimizer.arg(solution);
+        previousSolutionIsInteger = withIntegerConstraints;
 
+        // the bound of a model with fewer constraints is also a bound of the full model
         foundSolutionValue_ = optimizer.value();
+        foundSolutionBound_ = optimizer.bound();
+        timeIsUp = getRemainingTime() <= 0.0;
 
         size_t numIntegralVariables = 0;
         for(size_t i = 0; i < solution.size(); i++)
@@ -254,15 +477,27 @@ Solution Model::inferWithCuttingConstraints(const std::vector<ValueType>& weight
         newDivisionIDs = {};
         valid = verifySolution(solution, newDivisionIDs);
 
-        for(auto it = newDivisionIDs.begin(); it != newDivisionIDs.end(); ++it)
+        for(auto it = newDivisionIDs.begin(); it != newDivisionIDs.end();)
         {
             if(divisionIDs.count(*it))
-                newDivisionIDs.erase(it);
+                it = newDivisionIDs.erase(it);
+            else
+                ++it;
         }
 
         divisionIDs.insert(newDivisionIDs.begin(), newDivisionIDs.end());
         divCountNew = divisionIDs.size();
 
+        newExclusions.clear();
+        for(size_t e = 0; e < modelExclusionConstraints_.size(); ++e)
+        {
+            if(!isExclusionAdded[e] && !modelExclusionConstraints_[e].verifySolution(solution, segmentationHypotheses_))
+            {
+                isExclusionAdded[e] = true;
+                newExclusions.push_back(e);
+            }
+        }
+
         std::cout << "solution has energy: " << optimizer.value() << std::endl;
         std::cout << "Solving time: " << solve_time.count() << std::endl;
         std::cout << "divCount: " << divCount << std::endl;
@@ -271,7 +506,7 @@ Solution Model::inferWithCuttingConstraints(const std::vector<ValueType>& weight
 
         // uncomment for retry with ILP if at end of lp-relax
 
-        if(!valid && !withIntegerConstraints && divCountNew == divCount)
+        if(!valid && !withIntegerConstraints && divCountNew == divCount && newExclusions.empty())
         {
             std::cout << "Try again with integer constraint!" << std::endl;
             withIntegerConstraints = true;
@@ -286,12 +521,35 @@ Solution Model::inferWithCuttingConstraints(const std::vector<ValueType>& weight
         //     optimizerParam.integerConstraintNodeVar_ = true;
         // }
     }
-    while(!valid && divCountNew > divCount);
+    while(!valid && !timeIsUp && (divCountNew > divCount || !newExclusions.empty()));
+
+    // when the time is up before all needed constraints were added, the last solution may still violate them. 
+    // Switching off the tracks through the violations gives a feasible, if worse, solution
+    if(!valid && timeIsUp && withIntegerConstraints)
+    {
+        std::cout << "Time limit reached, repairing the last solution" << std::endl;
+        std::set<helpers::IdLabelType> violatedIDs;
+        verifySolution(solution, violatedIDs);
+        for(auto iter = exclusionConstraints_.begin(); iter != exclusionConstraints_.end() ; ++iter)
+        {
+            if(iter->verifySolution(solution, segmentationHypotheses_))
+                continue;
+            for(helpers::IdLabelType id : iter->getIds())
+                if(solution[segmentationHypotheses_[id].getDetectionVariable().getOpenGMVariableId()] > 0)
+                    violatedIDs.insert(id);
+        }
+        clearTracksThrough(violatedIDs, solution);
+        foundSolutionValue_ = model_.evaluate(solution);
+    }
+    printBoundAndGap();
 
 
     std::cout << "Model initialization time: " << model_time.count() << std::endl;
     std::cout << "Average solving time: " << (total_solve_time / iterCount).count() << std::endl;
     std::cout << "Number of iterations: " << iterCount << std::endl;
+    if(lazyExclusions)
+        std::cout << "Needed " << std::count(isExclusionAdded.begin(), isExclusionAdded.end(), true) << " of " 
+            << modelExclusionConstraints_.size() << " exclusion constraints" << std::endl;
 
     return solution;
 }
@@ -299,46 +557,113 @@ Solution Model::inferWithCuttingConstraints(const std::vector<ValueType>& weight
 Solution Model::infer(const std::vector<ValueType>& weights, bool withIntegerConstraints, bool withDivisionConstraints, bool withMergerConstrains)
 {
     std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+    inferenceStart_ = std::chrono::high_resolution_clock::now();
 
 	// use weights that were given
-	WeightsType weightObject(computeNumWeights());
-	assert(weights.size() == weightObject.numberOfWeights());
-	if(weights.size() != weightObject.numberOfWeights())
-	{
-		std::cout << "Provided length of vector with initial weights has wrong length!" << std::endl;
-		throw std::runtime_error("Provided length of vector with initial weights has wrong length!");
-	}
-	for(size_t i = 0; i < weights.size(); i++)
-		weightObject.setWeight(i, weights[i]);
+	WeightsType weightObject = makeWeightObject(weights);
+
+    // models without divisions and exclusions might be pure min cost flow problems, which do not need an ILP solver
+    bool tryMinCostFlow = settings_->useMinCostFlowSolver_ && withIntegerConstraints && divisionHypotheses_.empty() && exclusionConstraints_.empty();
+
+    // connected components whose links form a tree are solved exactly by dynamic programming. If other components remain,
+    // only the compact formulation can leave the tree components out, the indicator ILP then solves the whole model
+    std::set<IdLabelType> treeDetections;
+    bool tryDynamicProgramming = settings_->useDynamicProgramming_ && withIntegerConstraints;
+    if(tryDynamicProgramming)
+    {
+        size_t numComponents = findTreeComponents(treeDetections);
+        std::cout << treeDetections.size() << " of " << segmentationHypotheses_.size() << " detections in " 
+            << numComponents << " components lie in tree components" << std::endl;
+        if(treeDetections.empty() || (treeDetections.size() < segmentationHypotheses_.size() && !settings_->useCompactFormulation_))
+            tryDynamicProgramming = false;
+    }
+
+    // the compact formulation, the flow solver, the dynamic program and the rounding of relaxed solutions read appearances and disappearances from their own variables, 
+    // so do not substitute them there
+    bool substituteAppearanceDisappearance = settings_->substituteAppearanceDisappearance_ && !settings_->useCompactFormulation_ 
+        && !tryMinCostFlow && !tryDynamicProgramming && (withIntegerConstraints || !settings_->roundRelaxedSolution_);
 
+    // weights are fixed during inference, so the unaries can be evaluated once up front
     start = std::chrono::high_resolution_clock::now();
-    initializeOpenGMModel(weightObject, withDivisionConstraints, withMergerConstrains);
+    initializeOpenGMModel(weightObject, withDivisionConstraints, withMergerConstrains, true, substituteAppearanceDisappearance);
     end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> model_time = end - start;
 
+    if(tryMinCostFlow)
+    {
+        Solution solution;
+        start = std::chrono::high_resolution_clock::now();
+        bool solved = inferMinCostFlow(withMergerConstrains, solution);
+        end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> solve_time = end - start;
 
-#ifdef WITH_CPLEX
-    std::cout << "Using cplex optimizer" << std::endl;
-    typedef opengm::LPCplex2<GraphicalModelType, opengm::Minimizer> OptimizerType;
-#else
-    std::cout << "Using gurobi optimizer" << std::endl;
-    typedef opengm::LPGurobi2<GraphicalModelType, opengm::Minimizer> OptimizerType;
-#endif
-    std::cout << (withIntegerConstraints ? "With" : "Without") << " integer constraint" << std::endl;
+        if(solved)
+        {
+            foundSolutionBound_ = foundSolutionValue_;
+            std::cout << "solution has energy: " << foundSolutionValue_ << std::endl;
+            std::cout << "Model initializing time: " << model_time.count() << std::endl;
+            std::cout << "Solving time: " << solve_time.count() << std::endl;
+            return solution;
+        }
+    }
+
+    if(tryDynamicProgramming)
+    {
+        start = std::chrono::high_resolution_clock::now();
+        Solution solution(model_.numberOfVariables(), 0);
+        ValueType remainingEnergy = 0.0;
+        ValueType remainingBound = 0.0;
+        if(treeDetections.size() < segmentationHypotheses_.size())
+        {
+            CompactFormulation formulation = buildCompactFormulation(withDivisionConstraints, withMergerConstrains, false, false, treeDetections);
+            solution = formulation.solve(settings_, remainingEnergy, remainingBound, getRemainingTime());
+        }
+        inferTreeComponents(treeDetections, withDivisionConstraints, withMergerConstrains, solution);
+        end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> solve_time = end - start;
+
+        // the tree components are solved exactly, only the rest can leave a gap
+        foundSolutionValue_ = model_.evaluate(solution);
+        foundSolutionBound_ = foundSolutionValue_ - remainingEnergy + remainingBound;
+        std::cout << "solution has energy: " << foundSolutionValue_ << std::endl;
+        printBoundAndGap();
+        std::cout << "Model initializing time: " << model_time.count() << std::endl;
+        std::cout << "Solving time: " << solve_time.count() << std::endl;
+        return solution;
+    }
+
+    if(settings_->useCompactFormulation_)
+    {
+        if(withIntegerConstraints)
+        {
+            start = std::chrono::high_resolution_clock::now();
+            Solution solution = inferCompactFormulation(withDivisionConstraints, withMergerConstrains);
+            end = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> solve_time = end - start;
+
+            std::cout << "solution has energy: " << foundSolutionValue_ << std::endl;
+            printBoundAndGap();
+            std::cout << "Model initializing time: " << model_time.count() << std::endl;
+            std::cout << "Solving time: " << solve_time.count() << std::endl;
+            return solution;
+        }
+        std::cout << "Compact formulation is only available with integer constraints, using indicator formulation for the LP relaxation" << std::endl;
+    }
 
-    OptimizerType::Parameter optimizerParam;
-    optimizerParam.relaxation_ = OptimizerType::Parameter::TightPolytope;
-    optimizerParam.verbose_ = settings_->optimizerVerbose_;
-    optimizerParam.useSoftConstraints_ = false;
-    optimizerParam.integerConstraintNodeVar_ = withIntegerConstraints;
-    optimizerParam.epGap_ = settings_->optimizerEpGap_;
-    optimizerParam.numberOfThreads_ = settings_->optimizerNumThreads_;
+    std::cout << (withIntegerConstraints ? "With" : "Without") << " integer constraint" << std::endl;
+    OptimizerType::Parameter optimizerParam = makeOptimizerParameter(*settings_, withIntegerConstraints);
+    if(settings_->optimizerTimeLimit_ > 0.0)
+        optimizerParam.timeLimit_ = getRemainingTime();
 
     OptimizerType optimizer(model_, optimizerParam);
 
     Solution solution(model_.numberOfVariables());
     OptimizerType::VerboseVisitorType optimizerVisitor;
 
+    // the greedy labeling does not know about substituted variables, and LP relaxations do not use a starting point
+    if(withIntegerConstraints && settings_->useGreedyStartingPoint_ && numSubstitutedVariables_ == 0)
+        setGreedyStartingPoint(optimizer);
+
     start = std::chrono::high_resolution_clock::now();
     optimizer.infer(optimizerVisitor);
     end = std::chrono::high_resolution_clock::now();
@@ -347,17 +672,24 @@ Solution Model::infer(const std::vector<ValueType>& weights, bool withIntegerCon
     optimizer.arg(solution);
 
     size_t numIntegralVariables = 0;
+    std::vector<bool> isIntegral(solution.size(), false);
     for(size_t i = 0; i < solution.size(); i++)
     {
         opengm::IndependentFactor<double, size_t, size_t> values;
         optimizer.variable(i, values);
         double v = values(solution[i]);
         if(v == 0.0 || v == 1.0)
+        {
             numIntegralVariables++;
+            isIntegral[i] = true;
+        }
     }
     std::cout << numIntegralVariables << " variables of " << model_.numberOfVariables() << " are integral! "
             << 100.0 * float(numIntegralVariables) / model_.numberOfVariables() << "%" << std::endl;
 
+    // the energies of substituted variables are part of the remaining unaries, so only their states need to be filled in
+    reconstructSubstitutedVariables(solution);
+
     std::cout << "solution has energy: " << optimizer.value() << std::endl;
     std::cout << "Model initializing time: " << model_time.count() << std::endl;
     std::cout << "Solving time: " << solve_time.count() << std::endl;
@@ -372,93 +704,1949 @@ Solution Model::infer(const std::vector<ValueType>& weights, bool withIntegerCon
     // std::cout << "Solving time: " << solve_time.count() << std::endl;
 
     foundSolutionValue_ = optimizer.value();
-    return solution;
-}
+    foundSolutionBound_ = optimizer.bound();
 
-std::vector<ValueType> Model::learn()
-{
-	std::vector<helpers::ValueType> weights(computeNumWeights(), 0);
-	return learn(weights);
+    // the objective of the relaxation stays the lower bound for the rounded labeling
+    if(!withIntegerConstraints && settings_->roundRelaxedSolution_)
+    {
+        solution = roundRelaxedSolution(solution, isIntegral);
+        foundSolutionValue_ = model_.evaluate(solution);
+        std::cout << "rounded solution has energy: " << foundSolutionValue_ << std::endl;
+    }
+    printBoundAndGap();
+    return solution;
 }
 
-std::vector<ValueType> Model::learn(const std::vector<helpers::ValueType>& weights)
+Solution Model::inferReducedILP(const std::vector<ValueType>& weights)
 {
-	// prepare OpenGM for learning
-	DatasetType dataset;
-	WeightsType initialWeights(computeNumWeights());
+    std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+    inferenceStart_ = std::chrono::high_resolution_clock::now();
 
-	if(weights.size() != computeNumWeights())
-	{
-		std::cout << "Provided length of vector with initial weights has wrong length!" << std::endl;
-		throw std::runtime_error("Provided length of vector with initial weights has wrong length!");
-	}
-	for(size_t i = 0; i < weights.size(); ++i)
-	{
-		initialWeights.setWeight(i, weights[i]);
-	}
+	WeightsType weightObject = makeWeightObject(weights);
 
-	dataset.setWeights(initialWeights);
-	initializeOpenGMModel(dataset.getWeights());
+    start = std::chrono::high_resolution_clock::now();
+    initializeOpenGMModel(weightObject, true, true, true);
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> model_time = end - start;
 
-	// load GT from subclass-specified method
-	Solution gt = getGroundTruth();
+    OptimizerType::Parameter optimizerParam = makeOptimizerParameter(*settings_, false);
+    if(settings_->optimizerTimeLimit_ > 0.0)
+        optimizerParam.timeLimit_ = getRemainingTime();
 
-	dataset.pushBackInstance(model_, gt);
+    OptimizerType optimizer(model_, optimizerParam);
+    OptimizerType::VerboseVisitorType optimizerVisitor;
+    start = std::chrono::high_resolution_clock::now();
+    optimizer.infer(optimizerVisitor);
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> relaxation_time = end - start;
 
-	std::cout << "Done setting up dataset, creating learner" << std::endl;
-	opengm::learning::StructMaxMargin<DatasetType>::Parameter learnerParam;
-	learnerParam.optimizerParameter_.lambda = 1.00;
-	learnerParam.optimizerParameter_.nonNegativeWeights = settings_->nonNegativeWeightsOnly_;
-	opengm::learning::StructMaxMargin<DatasetType> learner(dataset, learnerParam);
+    Solution relaxedSolution(model_.numberOfVariables());
+    optimizer.arg(relaxedSolution);
+    ValueType relaxationBound = optimizer.bound();
 
-#ifdef WITH_CPLEX
-	typedef opengm::LPCplex2<GraphicalModelType, opengm::Minimizer> OptimizerType;
-#else
-	typedef opengm::LPGurobi2<GraphicalModelType, opengm::Minimizer> OptimizerType;
-#endif
+    // every variable that the relaxation assigns integrally keeps its state, only the fractional rest is left to the ILP
+    CompactFormulation formulation = buildCompactFormulation(true, true);
+    std::vector<bool> isIntegral(relaxedSolution.size(), false);
+    for(size_t i = 0; i < relaxedSolution.size(); i++)
+    {
+        opengm::IndependentFactor<double, size_t, size_t> values;
+        optimizer.variable(i, values);
+        double v = values(relaxedSolution[i]);
+        if(v == 0.0 || v == 1.0)
+        {
+            isIntegral[i] = true;
+            formulation.fixColumn(i, relaxedSolution[i]);
+        }
+    }
+    std::cout << "Reduced ILP has " << model_.numberOfVariables() - formulation.getNumFixedColumns() << " of " 
+        << model_.numberOfVariables() << " variables free, " << formulation.getNumFreeRows() << " of " 
+        << formulation.getNumRows() << " rows contain free variables" << std::endl;
 
-	OptimizerType::Parameter optimizerParam;
-	optimizerParam.integerConstraintNodeVar_ = true;
-	optimizerParam.relaxation_ = OptimizerType::Parameter::TightPolytope;
-	optimizerParam.verbose_ = settings_->optimizerVerbose_;
-	optimizerParam.useSoftConstraints_ = false;
-	optimizerParam.epGap_ = settings_->optimizerEpGap_;
-	optimizerParam.numberOfThreads_ = settings_->optimizerNumThreads_;
+    Solution solution;
+    start = std::chrono::high_resolution_clock::now();
+    try
+    {
+        ValueType energy, bound;
+        solution = formulation.solve(settings_, energy, bound, getRemainingTime());
+    }
+    catch(std::runtime_error& e)
+    {
+        // the fixed states can rule out every integer completion of the fractional part
+        std::cout << "Reduced ILP could not be solved (" << e.what() << "), rounding the relaxation instead" << std::endl;
+        solution = roundRelaxedSolution(relaxedSolution, isIntegral);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> solve_time = end - start;
 
-	std::cout << "Calling learn()..." << std::endl;
-	learner.learn<OptimizerType>(optimizerParam);
-	std::cout << "extracting weights" << std::endl;
-	const WeightsType& finalWeights = learner.getWeights();
-	std::vector<double> resultWeights;
-	for(size_t i = 0; i < finalWeights.numberOfWeights(); ++i)
-		resultWeights.push_back(finalWeights.getWeight(i));
-	return resultWeights;
+    foundSolutionValue_ = model_.evaluate(solution);
+    foundSolutionBound_ = relaxationBound;
+    std::cout << "solution has energy: " << foundSolutionValue_ << std::endl;
+    printBoundAndGap();
+    std::cout << "Model initializing time: " << model_time.count() << std::endl;
+    std::cout << "Relaxation solving time: " << relaxation_time.count() << std::endl;
+    std::cout << "Reduced ILP solving time: " << solve_time.count() << std::endl;
+    return solution;
 }
 
-double Model::evaluateSolution(const Solution& sol) const
+Solution Model::inferWithLinkPricing(const std::vector<ValueType>& weights, size_t initialLinksPerDetection)
 {
-	return model_.evaluate(sol);
-}
+    std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+    inferenceStart_ = std::chrono::high_resolution_clock::now();
 
-double Model::getLastSolutionValue() const
-{
-	return foundSolutionValue_;
-}
+	WeightsType weightObject = makeWeightObject(weights);
 
-// version for division constraints
-bool Model::verifySolution(const helpers::Solution& sol, std::set<int>& divisionIDs) const
-{
-	std::cout << "Checking solution..." << std::endl;
+    start = std::chrono::high_resolution_clock::now();
+    initializeOpenGMModel(weightObject, true, true, true);
+    CompactFormulation formulation = buildCompactFormulation(true, true);
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> model_time = end - start;
 
-	bool valid = true;
+    // the cost of the first unit of flow along each link, which is the slope of its convex envelope at zero
+    std::map<size_t, ValueType> linkCosts;
+    std::map<IdLabelType, std::vector<std::pair<ValueType, size_t> > > outgoingLinks;
+    std::map<IdLabelType, std::vector<std::pair<ValueType, size_t> > > incomingLinks;
+    for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end(); ++iter)
+    {
+        int column = iter->second->getVariable().getOpenGMVariableId();
+        if(column < 0)
+            continue;
+
+        const std::vector<ValueType>& energies = formulation.getStateEnergies(column);
+        if(energies.size() < 2)
+            continue;
+        ValueType cost = std::numeric_limits<ValueType>::infinity();
+        for(size_t state = 1; state < energies.size(); ++state)
+            cost = std::min(cost, (energies[state] - energies[0]) / state);
+
+        linkCosts[column] = cost;
+        outgoingLinks[iter->second->getSrcId()].push_back(std::make_pair(cost, column));
+        incomingLinks[iter->second->getDestId()].push_back(std::make_pair(cost, column));
+    }
 
-	// check that all exclusions are obeyed
-	for(auto iter = exclusionConstraints_.begin(); iter != exclusionConstraints_.end() ; ++iter)
-	{
-		if(!iter->verifySolution(sol, segmentationHypotheses_))
-		{
-			std::cout << "\tFound violated exclusion constraint " << std::endl;
-			valid = false;
+    // start with the cheapest incoming and outgoing links of every detection, all others are fixed to zero
+    std::set<size_t> activeLinks;
+    for(auto linksOfDetection : {&outgoingLinks, &incomingLinks})
+    {
+        for(auto iter = linksOfDetection->begin(); iter != linksOfDetection->end(); ++iter)
+        {
+            std::vector<std::pair<ValueType, size_t> >& links = iter->second;
+            size_t numLinks = std::min(links.size(), initialLinksPerDetection);
+            std::partial_sort(links.begin(), links.begin() + numLinks, links.end());
+            for(size_t i = 0; i < numLinks; ++i)
+                activeLinks.insert(links[i].second);
+        }
+    }
+    for(auto iter = linkCosts.begin(); iter != linkCosts.end(); ++iter)
+        if(activeLinks.count(iter->first) == 0)
+            formulation.fixColumn(iter->first, 0);
+
+    // rows in which the link columns appear, links with several states also enter merger rows through their
+    // activity column, which the pricing ignores
+    std::map<size_t, std::vector<std::pair<size_t, double> > > rowsOfLink;
+    for(size_t r = 0; r < formulation.getNumRows(); ++r)
+        for(auto& entry : formulation.getRow(r))
+            if(linkCosts.count(entry.first) > 0)
+                rowsOfLink[entry.first].push_back(std::make_pair(r, entry.second));
+
+    start = std::chrono::high_resolution_clock::now();
+    ValueType relaxationBound = 0.0;
+    for(size_t iteration = 0; ; ++iteration)
+    {
+        std::vector<double> rowDuals;
+        ValueType restrictedRelaxation = formulation.solveRelaxation(settings_, rowDuals);
+
+        // links whose reduced cost is negative could still improve the relaxation. The cost of a link is the slope 
+        // of its convex envelope at zero, so it can lower the relaxation by at most its reduced cost times its upper bound
+        std::vector<size_t> pricedLinks;
+        ValueType possibleImprovement = 0.0;
+        for(auto iter = linkCosts.begin(); iter != linkCosts.end(); ++iter)
+        {
+            if(activeLinks.count(iter->first) > 0)
+                continue;
+
+            double reducedCost = iter->second;
+            for(auto& entry : rowsOfLink[iter->first])
+                reducedCost -= entry.second * rowDuals[entry.first];
+            if(reducedCost < -1e-6)
+            {
+                pricedLinks.push_back(iter->first);
+                possibleImprovement += reducedCost * formulation.getUpperBound(iter->first);
+            }
+        }
+
+        // only once no link is left, the restricted relaxation is the relaxation over all links, before that the 
+        // Lagrangian bound is the best that is known
+        relaxationBound = restrictedRelaxation + possibleImprovement;
+        std::cout << "Pricing iteration " << iteration << ": restricted relaxation " << restrictedRelaxation 
+            << ", lower bound " << relaxationBound << ", adding " << pricedLinks.size() << " links" << std::endl;
+        if(pricedLinks.empty())
+            break;
+        if(getRemainingTime() <= 0.0)
+        {
+            std::cout << "Time limit reached before pricing converged, using the Lagrangian bound" << std::endl;
+            break;
+        }
+
+        for(size_t column : pricedLinks)
+        {
+            formulation.unfixColumn(column);
+            activeLinks.insert(column);
+        }
+    }
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> pricing_time = end - start;
+    std::cout << "Needed " << activeLinks.size() << " of " << linkCosts.size() << " link columns" << std::endl;
+
+    // the integer solution is restricted to the priced links, the (Lagrangian) relaxation over all links bounds it from below
+    start = std::chrono::high_resolution_clock::now();
+    ValueType energy, bound;
+    Solution solution = formulation.solve(settings_, energy, bound, getRemainingTime());
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> solve_time = end - start;
+
+    foundSolutionValue_ = model_.evaluate(solution);
+    foundSolutionBound_ = std::min(relaxationBound, foundSolutionValue_);
+    std::cout << "solution has energy: " << foundSolutionValue_ << std::endl;
+    printBoundAndGap();
+    std::cout << "Model initializing time: " << model_time.count() << std::endl;
+    std::cout << "Pricing time: " << pricing_time.count() << std::endl;
+    std::cout << "Restricted ILP solving time: " << solve_time.count() << std::endl;
+    return solution;
+}
+
+std::vector<PortfolioStrategy> Model::getDefaultPortfolio()
+{
+	return {
+		{"all constraints", false, false},
+		{"lazy division and merger constraints", true, false},
+		{"lazy division, merger and exclusion constraints", true, true}
+	};
+}
+
+Solution Model::inferPortfolio(const std::vector<ValueType>& weights, const std::vector<PortfolioStrategy>& strategies)
+{
+	if(strategies.empty())
+		throw std::runtime_error("The portfolio needs at least one strategy");
+	inferenceStart_ = std::chrono::high_resolution_clock::now();
+
+	WeightsType weightObject = makeWeightObject(weights);
+
+	initializeOpenGMModel(weightObject, true, true, true);
+
+	// the formulations only hold numbers, so they can be solved independently, each with its share of the threads
+	std::vector<CompactFormulation> formulations;
+	for(const PortfolioStrategy& strategy : strategies)
+		formulations.push_back(buildCompactFormulation(true, true, strategy.lazyDivisionAndMergerConstraints, strategy.lazyExclusionConstraints));
+
+	std::shared_ptr<Settings> solverSettings = std::make_shared<Settings>(*settings_);
+	size_t numThreads = settings_->optimizerNumThreads_ > 0 ? settings_->optimizerNumThreads_ : std::thread::hardware_concurrency();
+	solverSettings->optimizerNumThreads_ = std::max<size_t>(1, numThreads / strategies.size());
+	std::cout << "Racing " << strategies.size() << " strategies with " << solverSettings->optimizerNumThreads_ << " threads each" << std::endl;
+
+	// the first strategy that proves optimality (within the gap) cancels all others
+	std::atomic<bool> cancel(false);
+	std::mutex mutex;
+	int winner = -1;
+	std::vector<Solution> solutions(strategies.size());
+	std::vector<ValueType> energies(strategies.size(), std::numeric_limits<ValueType>::infinity());
+	std::vector<ValueType> bounds(strategies.size(), -std::numeric_limits<ValueType>::infinity());
+	double timeLimit = getRemainingTime();
+
+	auto race = [&](size_t i) {
+		std::chrono::time_point<std::chrono::high_resolution_clock> start = std::chrono::high_resolution_clock::now();
+		try
+		{
+			ValueType energy, bound;
+			Solution solution = formulations[i].solve(solverSettings, energy, bound, timeLimit, &cancel);
+			std::chrono::duration<double> solve_time = std::chrono::high_resolution_clock::now() - start;
+			bool optimal = energy - bound <= settings_->optimizerEpGap_ * std::max(1e-10, std::fabs(energy));
+
+			std::lock_guard<std::mutex> lock(mutex);
+			solutions[i] = solution;
+			energies[i] = energy;
+			bounds[i] = bound;
+			std::cout << "Strategy \"" << strategies[i].name << "\" finished after " << solve_time.count() << " secs with energy " 
+				<< energy << (optimal ? ", proven optimal" : "") << std::endl;
+			if(optimal && winner < 0)
+			{
+				winner = i;
+				cancel = true;
+			}
+		}
+		catch(std::runtime_error& e)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			std::cout << "Strategy \"" << strategies[i].name << "\" stopped without solution: " << e.what() << std::endl;
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for(size_t i = 0; i < strategies.size(); ++i)
+		threads.push_back(std::thread(race, i));
+	for(std::thread& thread : threads)
+		thread.join();
+
+	// without a proof of optimality, the best solution at the deadline wins
+	if(winner < 0)
+	{
+		for(size_t i = 0; i < strategies.size(); ++i)
+			if(!solutions[i].empty() && (winner < 0 || energies[i] < energies[winner]))
+				winner = i;
+		if(winner < 0)
+			throw std::runtime_error("No strategy of the portfolio found a solution");
+	}
+
+	std::cout << "Portfolio won by strategy \"" << strategies[winner].name << "\"" << std::endl;
+	foundSolutionValue_ = energies[winner];
+	foundSolutionBound_ = *std::max_element(bounds.begin(), bounds.end());
+	std::cout << "solution has energy: " << foundSolutionValue_ << std::endl;
+	printBoundAndGap();
+	return solutions[winner];
+}
+
+Solution Model::inferPerturbAndMAP(
+	const std::vector<ValueType>& weights, 
+	size_t numSamples, 
+	std::vector<double>& activationFrequencies,
+	double noiseScale, 
+	bool gumbelNoise, 
+	size_t numParallelSolves, 
+	unsigned int seed)
+{
+	inferenceStart_ = std::chrono::high_resolution_clock::now();
+
+	WeightsType weightObject = makeWeightObject(weights);
+
+	initializeOpenGMModel(weightObject, true, true, true);
+
+	// all samples share the rows of one formulation and only bring their own energies
+	CompactFormulation formulation = buildCompactFormulation(true, true);
+	ValueType bound;
+	Solution mapSolution = formulation.solve(settings_, foundSolutionValue_, bound, getRemainingTime());
+	foundSolutionBound_ = bound;
+	std::cout << "MAP solution has energy: " << foundSolutionValue_ << std::endl;
+
+	numParallelSolves = std::max<size_t>(1, std::min(numParallelSolves, numSamples));
+	std::shared_ptr<Settings> solverSettings = std::make_shared<Settings>(*settings_);
+	if(solverSettings->optimizerNumThreads_ > 0)
+		solverSettings->optimizerNumThreads_ = std::max<size_t>(1, solverSettings->optimizerNumThreads_ / numParallelSolves);
+
+	std::vector<size_t> numActive(model_.numberOfVariables(), 0);
+	size_t numSolvedSamples = 0;
+	std::mutex mutex;
+	std::atomic<size_t> nextSample(0);
+	std::exception_ptr error;
+	auto solveSamples = [&]() {
+		for(size_t k = nextSample++; k < numSamples; k = nextSample++)
+		{
+			try
+			{
+				// every sample has its own seed, so the result does not depend on the distribution over threads
+				std::mt19937 generator(seed + k);
+				std::vector< std::vector<ValueType> > energies(model_.numberOfVariables());
+				for(size_t i = 0; i < energies.size(); ++i)
+				{
+					energies[i] = formulation.getStateEnergies(i);
+					perturbEnergies(energies[i], noiseScale, gumbelNoise, generator);
+				}
+
+				ValueType sampleEnergy, sampleBound;
+				Solution sample = formulation.solve(solverSettings, energies, sampleEnergy, sampleBound, getRemainingTime());
+
+				std::lock_guard<std::mutex> lock(mutex);
+				for(size_t i = 0; i < sample.size(); ++i)
+					if(sample[i] > 0)
+						numActive[i]++;
+				numSolvedSamples++;
+			}
+			catch(...)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				error = std::current_exception();
+			}
+		}
+	};
+
+	std::chrono::time_point<std::chrono::high_resolution_clock> start = std::chrono::high_resolution_clock::now();
+	std::vector<std::thread> threads;
+	for(size_t t = 0; t < numParallelSolves; ++t)
+		threads.push_back(std::thread(solveSamples));
+	for(std::thread& thread : threads)
+		thread.join();
+	if(error)
+		std::rethrow_exception(error);
+	std::chrono::duration<double> sampling_time = std::chrono::high_resolution_clock::now() - start;
+
+	activationFrequencies.assign(model_.numberOfVariables(), 0.0);
+	for(size_t i = 0; i < numActive.size(); ++i)
+		activationFrequencies[i] = numSolvedSamples > 0 ? double(numActive[i]) / numSolvedSamples : 0.0;
+
+	std::cout << "Solved " << numSolvedSamples << " perturbed models in " << sampling_time.count() << " secs" << std::endl;
+	printBoundAndGap();
+	return mapSolution;
+}
+
+void Model::perturbEnergies(std::vector<ValueType>& energies, double noiseScale, bool gumbelNoise, std::mt19937& generator)
+{
+	// the solver minimizes, so the Gumbel sample is subtracted: argmin(E - g) is distributed as softmax(-E / noiseScale)
+	std::uniform_real_distribution<double> uniform(std::numeric_limits<double>::min(), 1.0);
+	std::normal_distribution<double> normal(0.0, noiseScale);
+	for(ValueType& e : energies)
+		e += gumbelNoise ? noiseScale * std::log(-std::log(uniform(generator))) : normal(generator);
+}
+
+std::vector<Solution> Model::inferBatch(const std::vector< std::vector<ValueType> >& weightsList, size_t numParallelSolves)
+{
+	std::vector<Solution> solutions;
+	if(weightsList.empty())
+		return solutions;
+
+	// check all weight vectors before solving any of them
+	for(const std::vector<ValueType>& weights : weightsList)
+		makeWeightObject(weights);
+
+	// the unaries refer to the weight object, so the model is built once and only its energies change with the weights
+	std::chrono::time_point<std::chrono::high_resolution_clock> start = std::chrono::high_resolution_clock::now();
+	WeightsType weightObject = makeWeightObject(weightsList[0]);
+	initializeOpenGMModel(weightObject, true, true, false);
+	std::chrono::duration<double> model_time = std::chrono::high_resolution_clock::now() - start;
+	std::cout << "Model initializing time: " << model_time.count() << std::endl;
+
+	if(settings_->useCompactFormulation_)
+	{
+		// the rows do not depend on the weights, so one formulation serves all weight vectors, which only bring their own energies
+		CompactFormulation formulation = buildCompactFormulation(true, true);
+		size_t numWeightVectors = weightsList.size();
+
+		numParallelSolves = std::max<size_t>(1, std::min(numParallelSolves, numWeightVectors));
+		std::shared_ptr<Settings> solverSettings = std::make_shared<Settings>(*settings_);
+		if(solverSettings->optimizerNumThreads_ > 0)
+			solverSettings->optimizerNumThreads_ = std::max<size_t>(1, solverSettings->optimizerNumThreads_ / numParallelSolves);
+
+		solutions.resize(numWeightVectors);
+		std::vector<ValueType> energies(numWeightVectors, 0.0);
+		std::vector<ValueType> bounds(numWeightVectors, 0.0);
+		double timeLimit = settings_->optimizerTimeLimit_ > 0.0 ? settings_->optimizerTimeLimit_ : std::numeric_limits<double>::infinity();
+		std::vector<std::exception_ptr> errors(numWeightVectors);
+		auto solveWeights = [&](size_t i, std::shared_ptr<Settings> solveSettings){
+			try
+			{
+				solutions[i] = formulation.solve(solveSettings, computeVariableEnergies(weightsList[i]), energies[i], bounds[i], timeLimit);
+			}
+			catch(...)
+			{
+				errors[i] = std::current_exception();
+			}
+		};
+
+		// every solution is feasible for all weight vectors. The first one is solved with all threads and is the starting point 
+		// of the others, one after the other each solve starts from the previous solution
+		solveWeights(0, settings_);
+		if(errors[0])
+			std::rethrow_exception(errors[0]);
+		formulation.setStartingPoint(solutions[0]);
+
+		std::atomic<size_t> nextWeights(1);
+		auto solveFormulations = [&](){
+			for(size_t i = nextWeights++; i < numWeightVectors; i = nextWeights++)
+			{
+				solveWeights(i, solverSettings);
+				if(numParallelSolves == 1 && !errors[i])
+					formulation.setStartingPoint(solutions[i]);
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for(size_t t = 0; t < numParallelSolves; ++t)
+			threads.push_back(std::thread(solveFormulations));
+		for(std::thread& thread : threads)
+			thread.join();
+
+		for(size_t i = 0; i < numWeightVectors; ++i)
+		{
+			if(errors[i])
+				std::rethrow_exception(errors[i]);
+			std::cout << "Weights " << i << ": solution has energy: " << energies[i] << ", lower bound: " << bounds[i] << std::endl;
+		}
+		foundSolutionValue_ = energies.back();
+		foundSolutionBound_ = bounds.back();
+		return solutions;
+	}
+
+	if(numParallelSolves > 1)
+		std::cout << "Parallel batch solves need the compact formulation, solving one after the other" << std::endl;
+
+	OptimizerType::Parameter optimizerParam = makeOptimizerParameter(*settings_, true);
+	if(settings_->optimizerTimeLimit_ > 0.0)
+		optimizerParam.timeLimit_ = settings_->optimizerTimeLimit_;
+
+	for(size_t i = 0; i < weightsList.size(); ++i)
+	{
+		weightObject = makeWeightObject(weightsList[i]);
+		OptimizerType optimizer(model_, optimizerParam);
+		OptimizerType::VerboseVisitorType optimizerVisitor;
+
+		// the constraints do not depend on the weights, so the previous solution is always a feasible start
+		if(i > 0)
+			optimizer.setStartingPoint(solutions.back().begin());
+		else if(settings_->useGreedyStartingPoint_)
+			setGreedyStartingPoint(optimizer);
+
+		start = std::chrono::high_resolution_clock::now();
+		optimizer.infer(optimizerVisitor);
+		std::chrono::duration<double> solve_time = std::chrono::high_resolution_clock::now() - start;
+
+		Solution solution(model_.numberOfVariables());
+		optimizer.arg(solution);
+		solutions.push_back(solution);
+		foundSolutionValue_ = optimizer.value();
+		foundSolutionBound_ = optimizer.bound();
+
+		std::cout << "Weights " << i << ": solution has energy: " << optimizer.value() << ", lower bound: " << optimizer.bound() << std::endl;
+		std::cout << "Solving time: " << solve_time.count() << std::endl;
+	}
+
+	return solutions;
+}
+
+Solution Model::inferInteractive(const std::vector<ValueType>& weights)
+{
+	std::chrono::time_point<std::chrono::high_resolution_clock> start = std::chrono::high_resolution_clock::now();
+	inferenceStart_ = start;
+
+	WeightsType weightObject = makeWeightObject(weights);
+
+	// edits only change costs and bounds of single columns, so the formulation and the optimizer's model are built once and kept
+	initializeOpenGMModel(weightObject, true, true, true);
+	interactiveFormulation_ = std::make_shared<CompactFormulation>(buildCompactFormulation(true, true));
+	interactiveWeights_ = weights;
+	interactiveSolution_.clear();
+	if(settings_->useGreedyStartingPoint_)
+		interactiveSolution_ = findGreedySolution();
+	std::chrono::duration<double> model_time = std::chrono::high_resolution_clock::now() - start;
+	std::cout << "Model initializing time: " << model_time.count() << std::endl;
+
+	return resolve();
+}
+
+Solution Model::resolve()
+{
+	if(!interactiveFormulation_)
+		throw std::runtime_error("Interactive inference must be started with inferInteractive() before re-solving");
+
+	std::chrono::time_point<std::chrono::high_resolution_clock> start = std::chrono::high_resolution_clock::now();
+	inferenceStart_ = start;
+
+	// the constraints never change, so the previous solution is feasible unless a state was fixed differently,
+	// in which case the optimizer repairs or discards the start
+	interactiveFormulation_->setStartingPoint(interactiveSolution_);
+	ValueType energy = 0.0;
+	ValueType bound = 0.0;
+	Solution solution = interactiveFormulation_->resolve(settings_, energy, bound, getRemainingTime());
+	std::chrono::duration<double> solve_time = std::chrono::high_resolution_clock::now() - start;
+
+	interactiveSolution_ = solution;
+	foundSolutionValue_ = energy;
+	foundSolutionBound_ = bound;
+	std::cout << "solution has energy: " << foundSolutionValue_ << std::endl;
+	printBoundAndGap();
+	std::cout << "Solving time: " << solve_time.count() << std::endl;
+	return solution;
+}
+
+void Model::setInteractiveWeights(const std::vector<ValueType>& weights)
+{
+	WeightsType weightObject = makeWeightObject(weights);
+	interactiveWeights_ = weights;
+	if(!interactiveFormulation_)
+		return;
+
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end(); ++iter)
+		updateInteractiveEnergies(iter->second->getVariable(), JsonTypes::Links, weightObject);
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end(); ++iter)
+		updateInteractiveEnergies(iter->second->getVariable(), JsonTypes::Divisions, weightObject);
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end(); ++iter)
+	{
+		updateInteractiveEnergies(iter->second.getDetectionVariable(), JsonTypes::Features, weightObject);
+		updateInteractiveEnergies(iter->second.getDivisionVariable(), JsonTypes::DivisionFeatures, weightObject);
+		updateInteractiveEnergies(iter->second.getAppearanceVariable(), JsonTypes::AppearanceFeatures, weightObject);
+		updateInteractiveEnergies(iter->second.getDisappearanceVariable(), JsonTypes::DisappearanceFeatures, weightObject);
+	}
+}
+
+void Model::setDetectionFeatures(IdLabelType id, JsonTypes type, const StateFeatureVector& features)
+{
+	setVariableFeatures(getDetectionVariable(id, type), type, features);
+}
+
+void Model::setLinkFeatures(IdLabelType srcId, IdLabelType destId, const StateFeatureVector& features)
+{
+	setVariableFeatures(getLinkVariable(srcId, destId), JsonTypes::Links, features);
+}
+
+void Model::fixDetectionState(IdLabelType id, JsonTypes type, size_t state)
+{
+	// getInteractiveColumn() throws if there is no formulation, so it has to be called before dereferencing it
+	size_t column = getInteractiveColumn(getDetectionVariable(id, type));
+	interactiveFormulation_->fixColumn(column, state);
+}
+
+void Model::fixLinkState(IdLabelType srcId, IdLabelType destId, size_t state)
+{
+	size_t column = getInteractiveColumn(getLinkVariable(srcId, destId));
+	interactiveFormulation_->fixColumn(column, state);
+}
+
+void Model::releaseDetectionState(IdLabelType id, JsonTypes type)
+{
+	size_t column = getInteractiveColumn(getDetectionVariable(id, type));
+	interactiveFormulation_->unfixColumn(column);
+}
+
+void Model::releaseLinkState(IdLabelType srcId, IdLabelType destId)
+{
+	size_t column = getInteractiveColumn(getLinkVariable(srcId, destId));
+	interactiveFormulation_->unfixColumn(column);
+}
+
+std::vector< std::vector<ValueType> > Model::computeVariableEnergies(const std::vector<ValueType>& weights) const
+{
+	if(weights.size() != numLinkWeights_ + numDetWeights_ + numDivWeights_ + numAppWeights_ + numDisWeights_ + numExternalDivWeights_)
+		throw std::runtime_error("Provided length of vector with weights has wrong length!");
+
+	WeightsType weightObject(weights.size());
+	for(size_t i = 0; i < weights.size(); i++)
+		weightObject.setWeight(i, weights[i]);
+
+	std::vector< std::vector<ValueType> > energies(model_.numberOfVariables());
+	auto computeEnergies = [&](const Variable& variable, JsonTypes type){
+		if(variable.getOpenGMVariableId() >= 0 && !variable.isSubstituted())
+			energies[variable.getOpenGMVariableId()] = variable.computeEnergies(settings_->statesShareWeights_, weightObject, getWeightIds(type));
+	};
+
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end(); ++iter)
+		computeEnergies(iter->second->getVariable(), JsonTypes::Links);
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end(); ++iter)
+		computeEnergies(iter->second->getVariable(), JsonTypes::Divisions);
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end(); ++iter)
+	{
+		computeEnergies(iter->second.getDetectionVariable(), JsonTypes::Features);
+		computeEnergies(iter->second.getDivisionVariable(), JsonTypes::DivisionFeatures);
+		computeEnergies(iter->second.getAppearanceVariable(), JsonTypes::AppearanceFeatures);
+		computeEnergies(iter->second.getDisappearanceVariable(), JsonTypes::DisappearanceFeatures);
+	}
+	return energies;
+}
+
+WeightsType Model::makeWeightObject(const std::vector<ValueType>& weights)
+{
+	WeightsType weightObject(computeNumWeights());
+	if(weights.size() != weightObject.numberOfWeights())
+	{
+		std::cout << "Provided length of vector with initial weights has wrong length!" << std::endl;
+		throw std::runtime_error("Provided length of vector with initial weights has wrong length!");
+	}
+	for(size_t i = 0; i < weights.size(); i++)
+		weightObject.setWeight(i, weights[i]);
+	return weightObject;
+}
+
+std::vector<size_t> Model::getWeightIds(JsonTypes type) const
+{
+	size_t offset = 0;
+	size_t numWeights = 0;
+	switch(type)
+	{
+		case JsonTypes::Links: numWeights = numLinkWeights_; break;
+		case JsonTypes::Features: offset = numLinkWeights_; numWeights = numDetWeights_; break;
+		case JsonTypes::DivisionFeatures: offset = numLinkWeights_ + numDetWeights_; numWeights = numDivWeights_; break;
+		case JsonTypes::AppearanceFeatures: offset = numLinkWeights_ + numDetWeights_ + numDivWeights_; numWeights = numAppWeights_; break;
+		case JsonTypes::DisappearanceFeatures: 
+			offset = numLinkWeights_ + numDetWeights_ + numDivWeights_ + numAppWeights_; numWeights = numDisWeights_; break;
+		case JsonTypes::Divisions: 
+			offset = numLinkWeights_ + numDetWeights_ + numDivWeights_ + numAppWeights_ + numDisWeights_; numWeights = numExternalDivWeights_; break;
+		default: throw std::runtime_error("No weights belong to features of type " + JsonTypeNames[type]);
+	}
+
+	std::vector<size_t> weightIds(numWeights);
+	std::iota(weightIds.begin(), weightIds.end(), offset);
+	return weightIds;
+}
+
+Variable& Model::getDetectionVariable(IdLabelType id, JsonTypes type)
+{
+	auto iter = segmentationHypotheses_.find(id);
+	if(iter == segmentationHypotheses_.end())
+	{
+		std::stringstream s;
+		s << "Cannot find segmentation hypothesis " << id;
+		throw std::runtime_error(s.str());
+	}
+
+	switch(type)
+	{
+		case JsonTypes::Features: return iter->second.getDetectionVariable();
+		case JsonTypes::DivisionFeatures: return iter->second.getDivisionVariable();
+		case JsonTypes::AppearanceFeatures: return iter->second.getAppearanceVariable();
+		case JsonTypes::DisappearanceFeatures: return iter->second.getDisappearanceVariable();
+		default: throw std::runtime_error("Segmentation hypotheses have no variable with features of type " + JsonTypeNames[type]);
+	}
+}
+
+Variable& Model::getLinkVariable(IdLabelType srcId, IdLabelType destId)
+{
+	auto iter = linkingHypotheses_.find(std::make_pair(srcId, destId));
+	if(iter == linkingHypotheses_.end())
+	{
+		std::stringstream s;
+		s << "Cannot find link from " << srcId << " to " << destId;
+		throw std::runtime_error(s.str());
+	}
+	return iter->second->getVariable();
+}
+
+void Model::setVariableFeatures(Variable& variable, JsonTypes type, const StateFeatureVector& features)
+{
+	// the weights of a type are shared by all its variables, so the features must keep their layout
+	if(features.size() != variable.getNumStates())
+		throw std::runtime_error("The new features must describe as many states as the old ones for " + JsonTypeNames[type]);
+	for(size_t state = 0; state < features.size(); ++state)
+		if(features[state].size() != variable.getNumFeatures(state))
+			throw std::runtime_error("The new features must have as many entries per state as the old ones for " + JsonTypeNames[type]);
+	variable.setFeatures(features);
+
+	if(interactiveFormulation_)
+	{
+		WeightsType weightObject(interactiveWeights_.size());
+		for(size_t i = 0; i < interactiveWeights_.size(); i++)
+			weightObject.setWeight(i, interactiveWeights_[i]);
+		updateInteractiveEnergies(variable, type, weightObject);
+	}
+}
+
+void Model::updateInteractiveEnergies(const Variable& variable, JsonTypes type, const WeightsType& weights)
+{
+	if(variable.getOpenGMVariableId() < 0)
+		return;
+
+	std::vector<ValueType> energies = variable.computeEnergies(settings_->statesShareWeights_, weights, getWeightIds(type));
+	interactiveFormulation_->setStateEnergies(variable.getOpenGMVariableId(), energies);
+
+	// the opengm model must agree, because evaluateSolution(), findGreedySolution() and improveByLocalSearch() read it
+	variable.setOpenGMEnergies(model_, energies);
+}
+
+size_t Model::getInteractiveColumn(const Variable& variable) const
+{
+	if(!interactiveFormulation_)
+		throw std::runtime_error("Interactive inference must be started with inferInteractive() before fixing or releasing states");
+	if(variable.getOpenGMVariableId() < 0)
+		throw std::runtime_error("Cannot fix the state of a variable that is not part of the model");
+	return variable.getOpenGMVariableId();
+}
+
+bool Model::inferMinCostFlow(bool withMergerConstrains, Solution& solution)
+{
+	// check that no constraint besides flow conservation is needed
+	if(!divisionHypotheses_.empty() || !exclusionConstraints_.empty())
+		return false;
+
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		const SegmentationHypothesis& hyp = iter->second;
+		bool hasAppearance = hyp.getAppearanceVariable().getOpenGMVariableId() >= 0;
+		bool hasDisappearance = hyp.getDisappearanceVariable().getOpenGMVariableId() >= 0;
+
+		if(hyp.getDivisionVariable().getOpenGMVariableId() >= 0 || hyp.getAppearanceVariable().isSubstituted() || hyp.getDisappearanceVariable().isSubstituted())
+		{
+			std::cout << "Model has divisions, cannot use min cost flow solver" << std::endl;
+			return false;
+		}
+
+		if(hyp.getFixedIncomingFlow() > 0)
+		{
+			std::cout << "Model has fixed incoming flow, cannot use min cost flow solver" << std::endl;
+			return false;
+		}
+
+		if(!settings_->allowLengthOneTracks_ && hasAppearance && hasDisappearance)
+		{
+			std::cout << "Length one tracks are forbidden, cannot use min cost flow solver" << std::endl;
+			return false;
+		}
+
+		if(withMergerConstrains && hyp.getDetectionVariable().getNumStates() > 1 && !settings_->allowPartialMergerAppearance_ && (hasAppearance || hasDisappearance))
+		{
+			std::cout << "Partial merger appearance is forbidden, cannot use min cost flow solver" << std::endl;
+			return false;
+		}
+	}
+
+	// each variable becomes a bundle of unit arcs with the energy increments as costs, which must be non-decreasing
+	bool isConvex = true;
+	forEachVariable([&](const Variable& variable){
+		if(variable.getOpenGMVariableId() < 0)
+			return;
+		std::vector<ValueType> energies = variable.getOpenGMEnergies(model_);
+		for(size_t state = 2; state < energies.size(); ++state)
+		{
+			if(energies[state] - energies[state - 1] < energies[state - 1] - energies[state - 2] - 1e-9)
+				isConvex = false;
+		}
+	});
+
+	if(!isConvex)
+	{
+		std::cout << "Energies are not convex in the number of objects, cannot use min cost flow solver" << std::endl;
+		return false;
+	}
+
+	std::map<helpers::IdLabelType, size_t> inNodes;
+	std::map<size_t, std::vector<size_t> > variableArcs;
+	ValueType constantEnergy = 0.0;
+	MinCostFlow flow = buildMinCostFlowGraph(std::set<size_t>(), inNodes, variableArcs, constantEnergy);
+
+	std::cout << "Solving min cost flow problem with " << flow.getNumNodes() << " nodes and " << flow.getNumArcs() << " arcs" << std::endl;
+	ValueType flowCost = flow.solve();
+	std::cout << "Sent " << flow.getFlowValue() << " units of flow" << std::endl;
+
+	solution = readFlowLabeling(flow, variableArcs);
+	foundSolutionValue_ = constantEnergy + flowCost;
+	return true;
+}
+
+MinCostFlow Model::buildMinCostFlowGraph(
+	const std::set<size_t>& blockedVariables,
+	std::map<helpers::IdLabelType, size_t>& inNodes,
+	std::map<size_t, std::vector<size_t> >& variableArcs,
+	ValueType& constantEnergy) const
+{
+	// every detection is split into an in- and an out-node, source = 0 and sink = 1
+	inNodes.clear();
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		size_t nextNode = 2 + 2 * inNodes.size();
+		inNodes[iter->first] = nextNode;
+	}
+
+	MinCostFlow flow(2 + 2 * inNodes.size(), 0, 1);
+	variableArcs.clear();
+	constantEnergy = 0.0;
+
+	// a variable with n states becomes n-1 parallel unit arcs, whose costs are the energy increments
+	auto addVariableArcs = [&](const Variable& variable, size_t from, size_t to){
+		if(variable.getOpenGMVariableId() < 0)
+			return;
+		std::vector<ValueType> energies = variable.getOpenGMEnergies(model_);
+		constantEnergy += energies[0];
+		if(blockedVariables.count(variable.getOpenGMVariableId()) > 0)
+			return;
+		std::vector<size_t>& arcs = variableArcs[variable.getOpenGMVariableId()];
+		for(size_t state = 1; state < energies.size(); ++state)
+			arcs.push_back(flow.addArc(from, to, energies[state] - energies[state - 1]));
+	};
+
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		size_t inNode = inNodes[iter->first];
+		addVariableArcs(iter->second.getDetectionVariable(), inNode, inNode + 1);
+		addVariableArcs(iter->second.getAppearanceVariable(), 0, inNode);
+		addVariableArcs(iter->second.getDisappearanceVariable(), inNode + 1, 1);
+
+		// a division provides the second unit of flow leaving the out-node
+		const Variable& division = iter->second.getDivisionVariable();
+		addVariableArcs(division, 0, inNode + 1);
+		if(division.getOpenGMVariableId() >= 0 && variableArcs.count(division.getOpenGMVariableId()) > 0)
+		{
+			for(size_t arc : variableArcs[division.getOpenGMVariableId()])
+				flow.setBlocked(arc, true);
+		}
+	}
+
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+	{
+		addVariableArcs(iter->second->getVariable(), inNodes[iter->first.first] + 1, inNodes[iter->first.second]);
+	}
+
+	return flow;
+}
+
+Solution Model::readFlowLabeling(const MinCostFlow& flow, const std::map<size_t, std::vector<size_t> >& variableArcs) const
+{
+	// the state of each variable is the number of its arcs that carry flow
+	Solution solution(model_.numberOfVariables(), 0);
+	for(auto iter = variableArcs.begin(); iter != variableArcs.end(); ++iter)
+	{
+		for(size_t arc : iter->second)
+		{
+			if(flow.hasFlow(arc))
+				solution[iter->first]++;
+		}
+	}
+	return solution;
+}
+
+size_t Model::blockFlowHeuristicViolations(const Solution& solution, std::set<size_t>& blockedVariables) const
+{
+	size_t numBlocked = 0;
+	auto block = [&](const Variable& variable){
+		if(variable.getOpenGMVariableId() >= 0 && blockedVariables.insert(variable.getOpenGMVariableId()).second)
+			numBlocked++;
+	};
+	auto value = [&](const Variable& variable) -> size_t {
+		return variable.getOpenGMVariableId() >= 0 ? solution[variable.getOpenGMVariableId()] : 0;
+	};
+
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		const SegmentationHypothesis& hyp = iter->second;
+		size_t appearanceValue = value(hyp.getAppearanceVariable());
+		size_t disappearanceValue = value(hyp.getDisappearanceVariable());
+
+		// tracks that start or end in the middle of a merger are rejected by verifySolution(), force them through the links
+		if(appearanceValue > 0 && hyp.getNumActiveIncomingLinks(solution) > 0)
+			block(hyp.getAppearanceVariable());
+		if(disappearanceValue > 0 && hyp.getNumActiveOutgoingLinks(solution) > 0)
+			block(hyp.getDisappearanceVariable());
+
+		if(!settings_->allowLengthOneTracks_ && appearanceValue > 0 && disappearanceValue > 0)
+		{
+			if(hyp.getNumActiveIncomingLinks(solution) == 0)
+				block(hyp.getAppearanceVariable());
+			else
+				block(hyp.getDetectionVariable());
+		}
+	}
+
+	// keep the detection with the lowest energy in its current state out of every violated exclusion constraint
+	for(auto iter = exclusionConstraints_.begin(); iter != exclusionConstraints_.end() ; ++iter)
+	{
+		std::vector<const Variable*> activeDetections;
+		for(helpers::IdLabelType id : iter->getIds())
+		{
+			const Variable& detection = segmentationHypotheses_.at(id).getDetectionVariable();
+			if(value(detection) > 0)
+				activeDetections.push_back(&detection);
+		}
+
+		if(activeDetections.size() < 2)
+			continue;
+
+		auto energy = [&](const Variable* detection){ return detection->getOpenGMEnergies(model_)[value(*detection)]; };
+		auto best = std::min_element(activeDetections.begin(), activeDetections.end(), 
+			[&](const Variable* a, const Variable* b){ return energy(a) < energy(b); });
+		for(auto it = activeDetections.begin(); it != activeDetections.end(); ++it)
+		{
+			if(it != best)
+				block(**it);
+		}
+	}
+
+	return numBlocked;
+}
+
+Solution Model::improveByLocalSearch(const Solution& solution, double timeLimit)
+{
+	std::chrono::time_point<std::chrono::high_resolution_clock> start = std::chrono::high_resolution_clock::now();
+	if(numSubstitutedVariables_ > 0 || solution.size() != model_.numberOfVariables())
+	{
+		std::cout << "Local search does not support substituted variables, keeping the solution" << std::endl;
+		return solution;
+	}
+	if(!verifySolution(solution))
+	{
+		std::cout << "Local search needs a feasible solution, keeping the given one" << std::endl;
+		return solution;
+	}
+
+	// unary energies of every variable, the constraints do not contribute to the energy of feasible labelings
+	std::vector< std::vector<ValueType> > energies(model_.numberOfVariables());
+	auto readEnergies = [&](const Variable& variable){
+		if(variable.getOpenGMVariableId() >= 0)
+			energies[variable.getOpenGMVariableId()] = variable.getOpenGMEnergies(model_);
+	};
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end(); ++iter)
+	{
+		readEnergies(iter->second.getDetectionVariable());
+		readEnergies(iter->second.getDivisionVariable());
+		readEnergies(iter->second.getAppearanceVariable());
+		readEnergies(iter->second.getDisappearanceVariable());
+	}
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end(); ++iter)
+		readEnergies(iter->second->getVariable());
+
+	// links by source and by target, as (other detection, variable id)
+	std::map<IdLabelType, std::vector< std::pair<IdLabelType, size_t> > > outgoingLinks;
+	std::map<IdLabelType, std::vector< std::pair<IdLabelType, size_t> > > incomingLinks;
+	std::map< std::pair<IdLabelType, IdLabelType>, size_t > linkIds;
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end(); ++iter)
+	{
+		int id = iter->second->getVariable().getOpenGMVariableId();
+		if(id < 0)
+			continue;
+		outgoingLinks[iter->first.first].push_back(std::make_pair(iter->first.second, (size_t)id));
+		incomingLinks[iter->first.second].push_back(std::make_pair(iter->first.first, (size_t)id));
+		linkIds[iter->first] = id;
+	}
+
+	Solution current = solution;
+	ValueType initialEnergy = model_.evaluate(current);
+	size_t numMoves = 0;
+
+	// apply the changes if they lower the energy and the touched detections stay feasible, otherwise leave the labeling as it was
+	typedef std::vector< std::pair<size_t, LabelType> > MoveType;
+	auto tryMove = [&](const MoveType& changes, const std::vector<IdLabelType>& touchedDetections){
+		ValueType delta = 0.0;
+		for(auto& change : changes)
+		{
+			if(change.second >= energies[change.first].size())
+				return false;
+			delta += energies[change.first][change.second] - energies[change.first][current[change.first]];
+		}
+		if(delta > -1e-9)
+			return false;
+
+		MoveType previous;
+		for(auto& change : changes)
+		{
+			previous.push_back(std::make_pair(change.first, current[change.first]));
+			current[change.first] = change.second;
+		}
+
+		for(IdLabelType id : touchedDetections)
+		{
+			if(!segmentationHypotheses_.at(id).verifySolution(current, settings_))
+			{
+				for(auto iter = previous.rbegin(); iter != previous.rend(); ++iter)
+					current[iter->first] = iter->second;
+				return false;
+			}
+		}
+		numMoves++;
+		return true;
+	};
+
+	auto getState = [&](const Variable& variable){
+		return variable.getOpenGMVariableId() >= 0 ? current[variable.getOpenGMVariableId()] : 0;
+	};
+	auto timeIsUp = [&](){
+		std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+		return elapsed.count() >= timeLimit;
+	};
+
+	bool improved = true;
+	while(improved && !timeIsUp())
+	{
+		improved = false;
+
+		for(auto link = linkIds.begin(); link != linkIds.end(); ++link)
+		{
+			IdLabelType a = link->first.first;
+			IdLabelType c = link->first.second;
+			const SegmentationHypothesis& source = segmentationHypotheses_.at(a);
+			const SegmentationHypothesis& target = segmentationHypotheses_.at(c);
+			int disappearance = source.getDisappearanceVariable().getOpenGMVariableId();
+			int appearance = target.getAppearanceVariable().getOpenGMVariableId();
+			bool singleObjects = getState(source.getDetectionVariable()) == 1 && getState(target.getDetectionVariable()) == 1;
+
+			if(current[link->second] == 0)
+			{
+				// merge a track that disappears at a with one that appears at c
+				if(singleObjects && disappearance >= 0 && appearance >= 0 && current[disappearance] == 1 && current[appearance] == 1)
+					improved |= tryMove({{link->second, 1}, {(size_t)disappearance, 0}, {(size_t)appearance, 0}}, {a, c});
+				continue;
+			}
+			if(current[link->second] != 1)
+				continue;
+
+			// split the track into a disappearance at a and an appearance at c
+			if(singleObjects && disappearance >= 0 && appearance >= 0 && getState(source.getDivisionVariable()) == 0)
+			{
+				if(tryMove({{link->second, 0}, {(size_t)disappearance, 1}, {(size_t)appearance, 1}}, {a, c}))
+				{
+					improved = true;
+					continue;
+				}
+			}
+
+			// swap targets with another active link b->d, such that a->d and b->c become active instead
+			for(auto& alternative : outgoingLinks[a])
+			{
+				IdLabelType d = alternative.first;
+				if(d == c || current[alternative.second] != 0)
+					continue;
+
+				bool swapped = false;
+				for(auto& other : incomingLinks[d])
+				{
+					IdLabelType b = other.first;
+					auto crossLink = linkIds.find(std::make_pair(b, c));
+					if(b == a || current[other.second] != 1 || crossLink == linkIds.end() || current[crossLink->second] != 0)
+						continue;
+
+					if(tryMove({{link->second, 0}, {other.second, 0}, {alternative.second, 1}, {crossLink->second, 1}}, {a, b, c, d}))
+					{
+						swapped = true;
+						break;
+					}
+				}
+				if(swapped)
+				{
+					improved = true;
+					break;
+				}
+			}
+
+			if(timeIsUp())
+				break;
+		}
+
+		// remove whole tracks that carry a single object from an appearance to a disappearance without dividing
+		for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() && !timeIsUp(); ++iter)
+		{
+			if(getState(iter->second.getAppearanceVariable()) != 1 || getState(iter->second.getDetectionVariable()) != 1)
+				continue;
+
+			MoveType changes;
+			std::vector<IdLabelType> touchedDetections;
+			IdLabelType id = iter->first;
+			bool isTrack = true;
+			while(true)
+			{
+				const SegmentationHypothesis& hyp = segmentationHypotheses_.at(id);
+				if(getState(hyp.getDetectionVariable()) != 1 || getState(hyp.getDivisionVariable()) != 0)
+				{
+					isTrack = false;
+					break;
+				}
+				changes.push_back(std::make_pair((size_t)hyp.getDetectionVariable().getOpenGMVariableId(), 0));
+				touchedDetections.push_back(id);
+				if(getState(hyp.getAppearanceVariable()) > 0)
+					changes.push_back(std::make_pair((size_t)hyp.getAppearanceVariable().getOpenGMVariableId(), 0));
+				if(getState(hyp.getDisappearanceVariable()) > 0)
+				{
+					changes.push_back(std::make_pair((size_t)hyp.getDisappearanceVariable().getOpenGMVariableId(), 0));
+					break;
+				}
+
+				// the single object leaves along exactly one link
+				const std::pair<IdLabelType, size_t>* next = nullptr;
+				for(auto& link : outgoingLinks[id])
+					if(current[link.second] > 0)
+						next = &link;
+				if(next == nullptr || touchedDetections.size() > segmentationHypotheses_.size())
+				{
+					isTrack = false;
+					break;
+				}
+				changes.push_back(std::make_pair(next->second, 0));
+				id = next->first;
+			}
+
+			if(isTrack)
+				improved |= tryMove(changes, touchedDetections);
+		}
+	}
+
+	foundSolutionValue_ = model_.evaluate(current);
+	std::chrono::duration<double> search_time = std::chrono::high_resolution_clock::now() - start;
+	std::cout << "Local search applied " << numMoves << " moves, energy went from " << initialEnergy 
+		<< " to " << foundSolutionValue_ << " in " << search_time.count() << " secs" << std::endl;
+	return current;
+}
+
+Solution Model::inferWithFlowHeuristic(const std::vector<ValueType>& weights)
+{
+	std::chrono::time_point<std::chrono::high_resolution_clock> start = std::chrono::high_resolution_clock::now();
+
+	WeightsType weightObject = makeWeightObject(weights);
+
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+		if(iter->second.getFixedIncomingFlow() > 0)
+			throw std::runtime_error("The flow heuristic does not support fixed incoming flow");
+
+	initializeOpenGMModel(weightObject, true, true, true);
+
+	// Phase 1: solve the pure flow problem, and forbid the variables that violate constraints beyond flow conservation until there are none.
+	// Every round blocks at least one more variable, so this terminates.
+	std::set<size_t> blockedVariables;
+	std::map<helpers::IdLabelType, size_t> inNodes;
+	std::map<size_t, std::vector<size_t> > variableArcs;
+	ValueType constantEnergy = 0.0;
+	MinCostFlow flow(2, 0, 1);
+	Solution solution;
+	size_t numRounds = 0;
+	do
+	{
+		flow = buildMinCostFlowGraph(blockedVariables, inNodes, variableArcs, constantEnergy);
+		flow.solve();
+		solution = readFlowLabeling(flow, variableArcs);
+		numRounds++;
+	}
+	while(blockFlowHeuristicViolations(solution, blockedVariables) > 0);
+	std::cout << "Flow heuristic needed " << numRounds << " rounds and blocked " << blockedVariables.size() << " variables" << std::endl;
+
+	// Phase 2: try divisions, cheapest first. A division sends a second unit from the source into the out-node of a detection
+	// that carries exactly one object, which then has to reach the sink. If the children must be separate, all arcs of used outgoing links
+	// (including the ones of higher states of multi-state links) are frozen, so the second unit has to take a link that is not used yet.
+	// Afterwards the flow around the dividing detection is frozen, such that later paths cannot change its state.
+	bool separateChildren = settings_->requireSeparateChildrenOfDivision_;
+	std::map<helpers::IdLabelType, std::vector<std::shared_ptr<LinkingHypothesis> > > outgoingLinks;
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+		outgoingLinks[iter->first.first].push_back(iter->second);
+
+	std::vector< std::pair<ValueType, helpers::IdLabelType> > divisionCandidates;
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		int divisionId = iter->second.getDivisionVariable().getOpenGMVariableId();
+		if(divisionId >= 0 && variableArcs.count(divisionId) > 0 && !variableArcs[divisionId].empty())
+		{
+			std::vector<ValueType> energies = iter->second.getDivisionVariable().getOpenGMEnergies(model_);
+			divisionCandidates.push_back(std::make_pair(energies[1] - energies[0], iter->first));
+		}
+	}
+	std::sort(divisionCandidates.begin(), divisionCandidates.end());
+
+	size_t numDivisions = 0;
+	for(auto candidate = divisionCandidates.begin(); candidate != divisionCandidates.end(); ++candidate)
+	{
+		const SegmentationHypothesis& hyp = segmentationHypotheses_.at(candidate->second);
+		int disappearanceId = hyp.getDisappearanceVariable().getOpenGMVariableId();
+		if(solution[hyp.getDetectionVariable().getOpenGMVariableId()] != 1 || (disappearanceId >= 0 && solution[disappearanceId] > 0))
+			continue;
+
+		// freeze the detection, its disappearance and the used outgoing links
+		std::vector<size_t> frozenArcs;
+		auto collectArcs = [&](const Variable& variable, bool onlyWithFlow){
+			auto it = variableArcs.find(variable.getOpenGMVariableId());
+			if(variable.getOpenGMVariableId() < 0 || it == variableArcs.end())
+				return;
+			for(size_t arc : it->second)
+				if(!onlyWithFlow || flow.hasFlow(arc))
+					frozenArcs.push_back(arc);
+		};
+		auto collectLinkArcs = [&](const Variable& variable){
+			auto it = variableArcs.find(variable.getOpenGMVariableId());
+			if(variable.getOpenGMVariableId() < 0 || it == variableArcs.end())
+				return;
+			bool used = std::any_of(it->second.begin(), it->second.end(), [&](size_t arc){ return flow.hasFlow(arc); });
+			collectArcs(variable, !(separateChildren && used));
+		};
+		collectArcs(hyp.getDetectionVariable(), false);
+		collectArcs(hyp.getDisappearanceVariable(), false);
+		for(auto& link : outgoingLinks[candidate->second])
+			collectLinkArcs(link->getVariable());
+
+		for(size_t arc : frozenArcs)
+			flow.setBlocked(arc, true);
+
+		std::vector<size_t> path;
+		ValueType pathCost = 0.0;
+		bool found = flow.findCheapestPath(inNodes[candidate->second] + 1, 1, path, pathCost);
+
+		if(!found || candidate->first + pathCost >= -1e-9)
+		{
+			for(size_t arc : frozenArcs)
+				flow.setBlocked(arc, false);
+			continue;
+		}
+
+		path.insert(path.begin(), flow.getResidualArc(variableArcs[hyp.getDivisionVariable().getOpenGMVariableId()][0]));
+		flow.augmentPath(path);
+		Solution divisionSolution = readFlowLabeling(flow, variableArcs);
+
+		// the rerouted flow might activate detections that violate other constraints, then take the division back
+		std::set<size_t> violatingVariables(blockedVariables);
+		if(blockFlowHeuristicViolations(divisionSolution, violatingVariables) > 0)
+		{
+			flow.augmentPath(path, true);
+			for(size_t arc : frozenArcs)
+				flow.setBlocked(arc, false);
+			continue;
+		}
+
+		// keep the division as well as both children fixed from now on
+		for(auto& link : outgoingLinks[candidate->second])
+			collectLinkArcs(link->getVariable());
+		for(size_t arc : frozenArcs)
+			flow.setBlocked(arc, true);
+
+		solution = divisionSolution;
+		numDivisions++;
+	}
+	std::cout << "Flow heuristic added " << numDivisions << " divisions" << std::endl;
+
+	// verifySolution() only checks the flow around a division, not that both children are different detections
+	auto hasSeparateChildren = [&]() -> bool {
+		for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+		{
+			int divisionId = iter->second.getDivisionVariable().getOpenGMVariableId();
+			if(divisionId < 0 || solution[divisionId] == 0)
+				continue;
+			for(auto& link : outgoingLinks[iter->first])
+				if(link->getVariable().getOpenGMVariableId() >= 0 && solution[link->getVariable().getOpenGMVariableId()] > 1)
+					return false;
+		}
+		return true;
+	};
+
+	if(!verifySolution(solution) || (separateChildren && !hasSeparateChildren()))
+	{
+		std::cout << "Flow heuristic did not find a valid solution, returning the empty tracking" << std::endl;
+		solution.assign(model_.numberOfVariables(), 0);
+	}
+
+	// the heuristic proves no bound
+	foundSolutionValue_ = model_.evaluate(solution);
+	foundSolutionBound_ = -std::numeric_limits<ValueType>::infinity();
+	std::chrono::duration<double> solve_time = std::chrono::high_resolution_clock::now() - start;
+	std::cout << "solution has energy: " << foundSolutionValue_ << std::endl;
+	std::cout << "Flow heuristic time: " << solve_time.count() << std::endl;
+	return solution;
+}
+
+Solution Model::findGreedySolution() const
+{
+	Solution solution(model_.numberOfVariables(), 0);
+
+	// objects on fixed links outside of the model are present from the start
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+		if(iter->second.getFixedIncomingFlow() > 0)
+			solution[iter->second.getDetectionVariable().getOpenGMVariableId()] = iter->second.getFixedIncomingFlow();
+
+	if(!extendGreedySolution(solution, std::set<helpers::IdLabelType>()))
+	{
+		std::cout << "Greedy construction did not find a valid solution, using the empty tracking" << std::endl;
+		solution.assign(model_.numberOfVariables(), 0);
+	}
+
+	return solution;
+}
+
+bool Model::extendGreedySolution(Solution& solution, const std::set<helpers::IdLabelType>& frozenDetections) const
+{
+	auto value = [&](const Variable& variable) -> size_t {
+		return variable.getOpenGMVariableId() >= 0 ? solution[variable.getOpenGMVariableId()] : 0;
+	};
+	// a variable can be increased if it exists and is not in its last state yet
+	auto canIncrease = [&](const Variable& variable) -> bool {
+		return variable.getOpenGMVariableId() >= 0 && value(variable) + 1 < variable.getNumStates();
+	};
+	auto increment = [&](const Variable& variable) -> ValueType {
+		std::vector<ValueType> energies = variable.getOpenGMEnergies(model_);
+		return energies[value(variable) + 1] - energies[value(variable)];
+	};
+
+	// order the detections topologically along their links, which is the order of the frames
+	std::map<helpers::IdLabelType, std::vector< std::pair<helpers::IdLabelType, const Variable*> > > outgoingLinks;
+	std::map<helpers::IdLabelType, size_t> numUnprocessedIncoming;
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+	{
+		outgoingLinks[iter->first.first].push_back(std::make_pair(iter->first.second, &(iter->second->getVariable())));
+		numUnprocessedIncoming[iter->first.second]++;
+	}
+
+	std::vector<helpers::IdLabelType> order;
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+		if(numUnprocessedIncoming[iter->first] == 0)
+			order.push_back(iter->first);
+	for(size_t i = 0; i < order.size(); ++i)
+	{
+		for(auto& link : outgoingLinks[order[i]])
+			if(--numUnprocessedIncoming[link.first] == 0)
+				order.push_back(link.first);
+	}
+
+	std::map<helpers::IdLabelType, std::vector<const ExclusionConstraint*> > exclusionsOfDetection;
+	for(auto iter = exclusionConstraints_.begin(); iter != exclusionConstraints_.end() ; ++iter)
+		for(helpers::IdLabelType id : iter->getIds())
+			exclusionsOfDetection[id].push_back(&(*iter));
+
+	auto isExcluded = [&](helpers::IdLabelType id) -> bool {
+		for(const ExclusionConstraint* exclusion : exclusionsOfDetection[id])
+			for(helpers::IdLabelType other : exclusion->getIds())
+				if(other != id && value(segmentationHypotheses_.at(other).getDetectionVariable()) > 0)
+					return true;
+		return false;
+	};
+
+	// a detection may only receive one more object if it could still leave through its disappearance, 
+	// so every decision made here keeps the labeling feasible
+	auto canReceive = [&](helpers::IdLabelType id) -> bool {
+		if(frozenDetections.count(id) > 0)
+			return false;
+		const SegmentationHypothesis& hyp = segmentationHypotheses_.at(id);
+		size_t units = value(hyp.getDetectionVariable());
+		if(!canIncrease(hyp.getDetectionVariable()) || hyp.getDisappearanceVariable().getOpenGMVariableId() < 0 
+			|| units + 1 >= hyp.getDisappearanceVariable().getNumStates())
+			return false;
+		return units > 0 || !isExcluded(id);
+	};
+
+	// cheapest link for one more object, returns the index into the outgoing links or -1
+	auto findCheapestLink = [&](helpers::IdLabelType id, int skip, ValueType& cost) -> int {
+		int best = -1;
+		std::vector< std::pair<helpers::IdLabelType, const Variable*> >& links = outgoingLinks[id];
+		for(size_t l = 0; l < links.size(); ++l)
+		{
+			if((int)l == skip || !canIncrease(*links[l].second) || !canReceive(links[l].first))
+				continue;
+			ValueType linkCost = increment(*links[l].second) + increment(segmentationHypotheses_.at(links[l].first).getDetectionVariable());
+			if(best < 0 || linkCost < cost)
+			{
+				best = l;
+				cost = linkCost;
+			}
+		}
+		return best;
+	};
+	auto useLink = [&](helpers::IdLabelType id, int l, int delta) {
+		std::pair<helpers::IdLabelType, const Variable*>& link = outgoingLinks[id][l];
+		solution[link.second->getOpenGMVariableId()] += delta;
+		solution[segmentationHypotheses_.at(link.first).getDetectionVariable().getOpenGMVariableId()] += delta;
+	};
+
+	for(helpers::IdLabelType id : order)
+	{
+		if(frozenDetections.count(id) > 0)
+			continue;
+
+		const SegmentationHypothesis& hyp = segmentationHypotheses_.at(id);
+		const Variable& detection = hyp.getDetectionVariable();
+		const Variable& appearance = hyp.getAppearanceVariable();
+		const Variable& disappearance = hyp.getDisappearanceVariable();
+		const Variable& division = hyp.getDivisionVariable();
+		size_t units = value(detection);
+		bool appeared = false;
+		bool canDisappear = canIncrease(disappearance);
+
+		// start a new track if it pays off within one step
+		if(units == 0)
+		{
+			if(!canIncrease(appearance) || !canIncrease(detection) || isExcluded(id))
+				continue;
+
+			ValueType cost = increment(appearance) + increment(detection);
+			ValueType exitCost = 0.0;
+			bool hasExit = findCheapestLink(id, -1, exitCost) >= 0;
+			if(settings_->allowLengthOneTracks_ && canDisappear && (!hasExit || increment(disappearance) < exitCost))
+			{
+				exitCost = increment(disappearance);
+				hasExit = true;
+			}
+
+			if(!hasExit || cost + exitCost >= 0.0)
+				continue;
+
+			solution[appearance.getOpenGMVariableId()] = 1;
+			solution[detection.getOpenGMVariableId()] = 1;
+			units = 1;
+			appeared = true;
+		}
+
+		// all objects either disappear together, or each takes the cheapest link that is still available
+		std::vector<int> usedLinks;
+		ValueType linkCost = 0.0;
+		for(size_t u = 0; u < units; ++u)
+		{
+			ValueType cost = 0.0;
+			int l = findCheapestLink(id, -1, cost);
+			if(l < 0)
+				break;
+			useLink(id, l, 1);
+			usedLinks.push_back(l);
+			linkCost += cost;
+		}
+
+		canDisappear = canDisappear && units < disappearance.getNumStates() && (settings_->allowLengthOneTracks_ || !appeared);
+		if(canDisappear)
+		{
+			std::vector<ValueType> energies = disappearance.getOpenGMEnergies(model_);
+			if(usedLinks.size() < units || energies[units] - energies[0] <= linkCost)
+			{
+				for(int l : usedLinks)
+					useLink(id, l, -1);
+				usedLinks.clear();
+				solution[disappearance.getOpenGMVariableId()] = units;
+				continue;
+			}
+		}
+
+		// a single object may divide if the second child is reached by a different link
+		if(units == 1 && usedLinks.size() == 1 && canIncrease(division))
+		{
+			ValueType cost = 0.0;
+			int l = findCheapestLink(id, usedLinks[0], cost);
+			if(l >= 0 && increment(division) + cost < 0.0)
+			{
+				solution[division.getOpenGMVariableId()] = 1;
+				useLink(id, l, 1);
+			}
+		}
+	}
+
+	return order.size() == segmentationHypotheses_.size() && verifySolution(solution);
+}
+
+void Model::clearTracksThrough(const std::set<helpers::IdLabelType>& detectionIds, Solution& solution) const
+{
+	auto isActive = [&](const Variable& variable) -> bool {
+		return variable.getOpenGMVariableId() >= 0 && solution[variable.getOpenGMVariableId()] > 0;
+	};
+	auto clear = [&](const Variable& variable) {
+		if(variable.getOpenGMVariableId() >= 0)
+			solution[variable.getOpenGMVariableId()] = 0;
+	};
+
+	// detections are connected by active links and external divisions
+	std::map<helpers::IdLabelType, std::vector<helpers::IdLabelType> > neighbors;
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+	{
+		if(!isActive(iter->second->getVariable()))
+			continue;
+		neighbors[iter->first.first].push_back(iter->first.second);
+		neighbors[iter->first.second].push_back(iter->first.first);
+	}
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+	{
+		if(!isActive(iter->second->getVariable()))
+			continue;
+		for(helpers::IdLabelType child : iter->second->getChildrenIds())
+		{
+			neighbors[iter->second->getParentId()].push_back(child);
+			neighbors[child].push_back(iter->second->getParentId());
+		}
+	}
+
+	// collect the connected components of the given detections, they are closed under active links
+	std::set<helpers::IdLabelType> component;
+	std::vector<helpers::IdLabelType> queue;
+	for(helpers::IdLabelType id : detectionIds)
+	{
+		if(segmentationHypotheses_.count(id) > 0 && component.insert(id).second)
+			queue.push_back(id);
+	}
+	for(size_t i = 0; i < queue.size(); ++i)
+	{
+		for(helpers::IdLabelType neighbor : neighbors[queue[i]])
+			if(component.insert(neighbor).second)
+				queue.push_back(neighbor);
+	}
+
+	// switching off complete tracks keeps flow conservation everywhere else, and exclusions cannot become violated
+	for(helpers::IdLabelType id : component)
+	{
+		const SegmentationHypothesis& hyp = segmentationHypotheses_.at(id);
+		clear(hyp.getDetectionVariable());
+		clear(hyp.getAppearanceVariable());
+		clear(hyp.getDisappearanceVariable());
+		clear(hyp.getDivisionVariable());
+	}
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+	{
+		if(component.count(iter->first.first) > 0)
+			clear(iter->second->getVariable());
+	}
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+	{
+		if(component.count(iter->second->getParentId()) > 0)
+			clear(iter->second->getVariable());
+	}
+
+	// objects on fixed links outside of the model cannot be switched off, they leave through the disappearance if possible
+	for(helpers::IdLabelType id : component)
+	{
+		const SegmentationHypothesis& hyp = segmentationHypotheses_.at(id);
+		size_t fixedFlow = hyp.getFixedIncomingFlow();
+		if(fixedFlow == 0)
+			continue;
+		solution[hyp.getDetectionVariable().getOpenGMVariableId()] = fixedFlow;
+		if(hyp.getDisappearanceVariable().getOpenGMVariableId() >= 0 && fixedFlow < hyp.getDisappearanceVariable().getNumStates())
+			solution[hyp.getDisappearanceVariable().getOpenGMVariableId()] = fixedFlow;
+	}
+
+	std::cout << "Cleared " << component.size() << " detections on tracks through " << detectionIds.size() << " violated detections" << std::endl;
+}
+
+Solution Model::roundRelaxedSolution(const Solution& relaxedSolution, const std::vector<bool>& isIntegral) const
+{
+	Solution solution(relaxedSolution);
+	auto isFractional = [&](const Variable& variable) -> bool {
+		return variable.getOpenGMVariableId() >= 0 && !isIntegral[variable.getOpenGMVariableId()];
+	};
+
+	// detections where the relaxation is undecided, fractional links and divisions concern all their endpoints
+	std::set<helpers::IdLabelType> violatedIDs;
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		const SegmentationHypothesis& hyp = iter->second;
+		if(isFractional(hyp.getDetectionVariable()) || isFractional(hyp.getDivisionVariable()) 
+			|| isFractional(hyp.getAppearanceVariable()) || isFractional(hyp.getDisappearanceVariable()))
+			violatedIDs.insert(iter->first);
+	}
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+	{
+		if(!isFractional(iter->second->getVariable()))
+			continue;
+		violatedIDs.insert(iter->first.first);
+		violatedIDs.insert(iter->first.second);
+	}
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+	{
+		if(!isFractional(iter->second->getVariable()))
+			continue;
+		violatedIDs.insert(iter->second->getParentId());
+		for(helpers::IdLabelType child : iter->second->getChildrenIds())
+			violatedIDs.insert(child);
+	}
+	std::cout << "Relaxation is undecided at " << violatedIDs.size() << " of " << segmentationHypotheses_.size() << " detections" << std::endl;
+
+	// detections whose fixed incoming flow had to be restored by clearTracksThrough() without a way out, 
+	// these are left to the greedy constructor
+	auto hasUnroutedFixedFlow = [&](const SegmentationHypothesis& hyp) -> bool {
+		return hyp.getFixedIncomingFlow() > 0 && hyp.getNumActiveOutgoingLinks(solution) == 0
+			&& solution[hyp.getDetectionVariable().getOpenGMVariableId()] == hyp.getFixedIncomingFlow()
+			&& (hyp.getDisappearanceVariable().getOpenGMVariableId() < 0 || solution[hyp.getDisappearanceVariable().getOpenGMVariableId()] == 0)
+			&& (hyp.getDivisionVariable().getOpenGMVariableId() < 0 || solution[hyp.getDivisionVariable().getOpenGMVariableId()] == 0);
+	};
+
+	// keep the integral part: switch off the tracks through undecided detections and through everything that the 
+	// rounded states still violate, until the labeling is feasible
+	for(size_t round = 0; round <= segmentationHypotheses_.size(); ++round)
+	{
+		verifySolution(solution, violatedIDs);
+		for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+			if(hasUnroutedFixedFlow(iter->second))
+				violatedIDs.erase(iter->first);
+		for(auto iter = exclusionConstraints_.begin(); iter != exclusionConstraints_.end() ; ++iter)
+		{
+			if(iter->verifySolution(solution, segmentationHypotheses_))
+				continue;
+			for(helpers::IdLabelType id : iter->getIds())
+				if(solution[segmentationHypotheses_.at(id).getDetectionVariable().getOpenGMVariableId()] > 0)
+					violatedIDs.insert(id);
+		}
+
+		if(violatedIDs.empty())
+			break;
+		clearTracksThrough(violatedIDs, solution);
+		violatedIDs.clear();
+	}
+
+	// the kept tracks stay as they are, the greedy constructor fills in the rest around them
+	std::set<helpers::IdLabelType> keptDetections;
+	bool needsExtension = false;
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		if(hasUnroutedFixedFlow(iter->second))
+			needsExtension = true;
+		else if(solution[iter->second.getDetectionVariable().getOpenGMVariableId()] > 0)
+			keptDetections.insert(iter->first);
+	}
+
+	ValueType keptEnergy = model_.evaluate(solution);
+	Solution extendedSolution(solution);
+	if(extendGreedySolution(extendedSolution, keptDetections) && (needsExtension || model_.evaluate(extendedSolution) < keptEnergy))
+		solution = extendedSolution;
+
+	std::cout << "Rounding kept " << keptDetections.size() << " active detections of the relaxation, energy of the kept part: " 
+		<< keptEnergy << ", after greedy repair: " << model_.evaluate(solution) << std::endl;
+
+	// if the greedy constructor cannot route the restored fixed incoming flow, the labeling is still inconsistent
+	if(!verifySolution(solution))
+	{
+		std::cout << "Rounding did not find a valid solution, falling back to the greedy construction" << std::endl;
+		solution = findGreedySolution();
+		if(!verifySolution(solution))
+			throw std::runtime_error("Could not round the relaxed solution to a labeling that satisfies all constraints");
+	}
+	return solution;
+}
+
+size_t Model::findTreeComponents(std::set<IdLabelType>& treeDetections) const
+{
+	// union find over the detections
+	std::map<IdLabelType, IdLabelType> parents;
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+		parents[iter->first] = iter->first;
+
+	std::function<IdLabelType(IdLabelType)> findRoot = [&](IdLabelType id) -> IdLabelType {
+		if(parents[id] != id)
+			parents[id] = findRoot(parents[id]);
+		return parents[id];
+	};
+	auto unite = [&](IdLabelType a, IdLabelType b){
+		parents[findRoot(a)] = findRoot(b);
+	};
+
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+		unite(iter->first.first, iter->first.second);
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+	{
+		for(IdLabelType child : iter->second->getChildrenIds())
+			unite(iter->second->getParentId(), child);
+	}
+	for(auto iter = exclusionConstraints_.begin(); iter != exclusionConstraints_.end() ; ++iter)
+	{
+		for(IdLabelType id : iter->getIds())
+			unite(iter->getIds().front(), id);
+	}
+
+	// a connected component is a tree iff it has one link less than detections
+	std::map<IdLabelType, int> numDetections;
+	std::map<IdLabelType, int> numLinks;
+	std::set<IdLabelType> hardComponents;
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+		numDetections[findRoot(iter->first)]++;
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+		numLinks[findRoot(iter->first.first)]++;
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+		hardComponents.insert(findRoot(iter->second->getParentId()));
+	for(auto iter = exclusionConstraints_.begin(); iter != exclusionConstraints_.end() ; ++iter)
+		hardComponents.insert(findRoot(iter->getIds().front()));
+
+	treeDetections.clear();
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		IdLabelType root = findRoot(iter->first);
+		if(hardComponents.count(root) == 0 && numLinks[root] + 1 == numDetections[root])
+			treeDetections.insert(iter->first);
+	}
+
+	return numDetections.size();
+}
+
+ValueType Model::inferTreeComponents(
+	const std::set<IdLabelType>& treeDetections, 
+	bool withDivisionConstraints, 
+	bool withMergerConstrains, 
+	Solution& solution) const
+{
+	auto getEnergies = [&](const Variable& variable){
+		if(variable.getOpenGMVariableId() < 0)
+			return std::vector<ValueType>();
+		if(variable.isSubstituted())
+			throw std::runtime_error("Cannot solve tree components of a model with substituted variables");
+		return variable.getOpenGMEnergies(model_);
+	};
+
+	TreeDynamicProgram program;
+	std::map<IdLabelType, size_t> nodes;
+	for(IdLabelType id : treeDetections)
+	{
+		const SegmentationHypothesis& hyp = segmentationHypotheses_.at(id);
+
+		// the same constraints that the segmentation hypothesis adds to the ILP
+		TreeDynamicProgram::NodeConstraints constraints;
+		constraints.division = withDivisionConstraints;
+		constraints.separateChildren = settings_->requireSeparateChildrenOfDivision_;
+		constraints.noLengthOneTracks = !settings_->allowLengthOneTracks_;
+		bool mergerConstraints = withMergerConstrains && hyp.getDetectionVariable().getNumStates() > 1;
+		constraints.noPartialMergerAppearance = mergerConstraints && !settings_->allowPartialMergerAppearance_;
+		constraints.noDisappearanceWithDivision = mergerConstraints;
+		constraints.fixedIncomingFlow = hyp.getFixedIncomingFlow();
+
+		nodes[id] = program.addNode(
+			getEnergies(hyp.getDetectionVariable()),
+			getEnergies(hyp.getAppearanceVariable()),
+			getEnergies(hyp.getDisappearanceVariable()),
+			getEnergies(hyp.getDivisionVariable()),
+			constraints);
+	}
+
+	std::map<size_t, const Variable*> arcVariables;
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+	{
+		if(treeDetections.count(iter->first.first) == 0)
+			continue;
+		const Variable& variable = iter->second->getVariable();
+		size_t arc = program.addArc(nodes[iter->first.first], nodes[iter->first.second], getEnergies(variable));
+		arcVariables[arc] = &variable;
+	}
+
+	ValueType energy = program.solve();
+
+	auto setState = [&](const Variable& variable, size_t state){
+		if(variable.getOpenGMVariableId() >= 0)
+			solution[variable.getOpenGMVariableId()] = state;
+	};
+	for(auto iter = nodes.begin(); iter != nodes.end(); ++iter)
+	{
+		const SegmentationHypothesis& hyp = segmentationHypotheses_.at(iter->first);
+		setState(hyp.getDetectionVariable(), program.getDetectionState(iter->second));
+		setState(hyp.getAppearanceVariable(), program.getAppearanceState(iter->second));
+		setState(hyp.getDisappearanceVariable(), program.getDisappearanceState(iter->second));
+		setState(hyp.getDivisionVariable(), program.getDivisionState(iter->second));
+	}
+	for(auto iter = arcVariables.begin(); iter != arcVariables.end(); ++iter)
+		setState(*iter->second, program.getArcState(iter->first));
+
+	std::cout << "Solved " << program.getNumNodes() << " detections and " << program.getNumArcs() 
+		<< " links in tree components by dynamic programming" << std::endl;
+	return energy;
+}
+
+CompactFormulation Model::buildCompactFormulation(
+	bool withDivisionConstraints, 
+	bool withMergerConstrains, 
+	bool lazyDivisionAndMergerConstraints, 
+	bool lazyExclusionConstraints,
+	const std::set<IdLabelType>& skippedDetections)
+{
+	CompactFormulation formulation(model_.numberOfVariables());
+	auto setEnergies = [&](const Variable& variable){
+		if(variable.getOpenGMVariableId() >= 0)
+			formulation.setStateEnergies(variable.getOpenGMVariableId(), variable.getOpenGMEnergies(model_));
+	};
+
+	// columns without energies only have state 0, so skipped detections and their links drop out of the problem
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		if(skippedDetections.count(iter->first) > 0)
+			continue;
+		setEnergies(iter->second.getDetectionVariable());
+		setEnergies(iter->second.getDivisionVariable());
+		setEnergies(iter->second.getAppearanceVariable());
+		setEnergies(iter->second.getDisappearanceVariable());
+	}
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+	{
+		if(skippedDetections.count(iter->first.first) == 0)
+			setEnergies(iter->second->getVariable());
+	}
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+	{
+		if(skippedDetections.count(iter->second->getParentId()) == 0)
+			setEnergies(iter->second->getVariable());
+	}
+
+	// every detection gets its own lazy group, like the cutting constraints are added per detection
+	int lazyGroup = 0;
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		if(skippedDetections.count(iter->first) > 0)
+			continue;
+		iter->second.addToCompactFormulation(formulation, settings_, withDivisionConstraints, withMergerConstrains, 
+			lazyDivisionAndMergerConstraints ? lazyGroup++ : -1);
+	}
+
+	for(auto iter = modelExclusionConstraints_.begin(); iter != modelExclusionConstraints_.end() ; ++iter)
+	{
+		formulation.setLazyGroup(lazyExclusionConstraints ? lazyGroup++ : -1);
+		iter->addToCompactFormulation(formulation, segmentationHypotheses_);
+	}
+	formulation.setLazyGroup(-1);
+
+	std::cout << "Compact formulation has " << formulation.getNumColumns() << " columns (" 
+		<< formulation.getNumColumns() - model_.numberOfVariables() << " activity columns) and " 
+		<< formulation.getNumRows() << " rows in " << formulation.getNumLazyGroups() << " lazy groups" << std::endl;
+	return formulation;
+}
+
+Solution Model::inferCompactFormulation(
+	bool withDivisionConstraints, 
+	bool withMergerConstrains, 
+	bool lazyDivisionAndMergerConstraints, 
+	bool lazyExclusionConstraints)
+{
+	CompactFormulation formulation = buildCompactFormulation(withDivisionConstraints, withMergerConstrains, 
+		lazyDivisionAndMergerConstraints, lazyExclusionConstraints);
+
+	ValueType energy = 0.0;
+	ValueType bound = 0.0;
+	Solution solution = formulation.solve(settings_, energy, bound, getRemainingTime());
+	foundSolutionValue_ = energy;
+	foundSolutionBound_ = bound;
+	return solution;
+}
+
+std::vector<ValueType> Model::learn()
+{
+	std::vector<helpers::ValueType> weights(computeNumWeights(), 0);
+	return learn(weights);
+}
+
+std::vector<ValueType> Model::learn(const std::vector<helpers::ValueType>& weights)
+{
+	// prepare OpenGM for learning
+	DatasetType dataset;
+	WeightsType initialWeights = makeWeightObject(weights);
+
+	dataset.setWeights(initialWeights);
+	initializeOpenGMModel(dataset.getWeights());
+
+	// load GT from subclass-specified method
+	Solution gt = getGroundTruth();
+
+	dataset.pushBackInstance(model_, gt);
+
+	std::cout << "Done setting up dataset, creating learner" << std::endl;
+	opengm::learning::StructMaxMargin<DatasetType>::Parameter learnerParam;
+	learnerParam.optimizerParameter_.lambda = 1.00;
+	learnerParam.optimizerParameter_.nonNegativeWeights = settings_->nonNegativeWeightsOnly_;
+	opengm::learning::StructMaxMargin<DatasetType> learner(dataset, learnerParam);
+
+	OptimizerType::Parameter optimizerParam = makeOptimizerParameter(*settings_, true);
+
+	std::cout << "Calling learn()..." << std::endl;
+	learner.learn<OptimizerType>(optimizerParam);
+	std::cout << "extracting weights" << std::endl;
+	const WeightsType& finalWeights = learner.getWeights();
+	std::vector<double> resultWeights;
+	for(size_t i = 0; i < finalWeights.numberOfWeights(); ++i)
+		resultWeights.push_back(finalWeights.getWeight(i));
+	return resultWeights;
+}
+
+double Model::evaluateSolution(const Solution& sol) const
+{
+	return model_.evaluate(sol);
+}
+
+double Model::getLastSolutionValue() const
+{
+	return foundSolutionValue_;
+}
+
+double Model::getLastSolutionBound() const
+{
+	return foundSolutionBound_;
+}
+
+double Model::getLastSolutionGap() const
+{
+	// relative to the energy, like the MIP gap of gurobi and cplex
+	return std::abs(foundSolutionValue_ - foundSolutionBound_) / std::max(1e-10, std::abs(foundSolutionValue_));
+}
+
+double Model::getRemainingTime() const
+{
+	if(settings_->optimizerTimeLimit_ <= 0.0)
+		return std::numeric_limits<double>::infinity();
+
+	std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - inferenceStart_;
+	return std::max(0.0, settings_->optimizerTimeLimit_ - elapsed.count());
+}
+
+void Model::printBoundAndGap() const
+{
+	std::cout << "Lower bound: " << foundSolutionBound_ << ", gap: " << getLastSolutionGap() << std::endl;
+}
+
+// version for division constraints
+bool Model::verifySolution(const helpers::Solution& sol, std::set<helpers::IdLabelType>& divisionIDs) const
+{
+	std::cout << "Checking solution..." << std::endl;
+
+	bool valid = true;
+
+	// check that all exclusions are obeyed
+	for(auto iter = exclusionConstraints_.begin(); iter != exclusionConstraints_.end() ; ++iter)
+	{
+		if(!iter->verifySolution(sol, segmentationHypotheses_))
+		{
+			std::cout << "\tFound violated exclusion constraint " << std::endl;
+			valid = false;
 		}
 	}
 
@@ -579,6 +2767,18 @@ std::vector<std::string> Model::getWeightDescriptions()
 	return descriptions;
 }
 
+void Model::reconstructSubstitutedVariables(helpers::Solution& solution) const
+{
+	if(numSubstitutedVariables_ == 0)
+		return;
+
+	solution.resize(model_.numberOfVariables() + numSubstitutedVariables_, 0);
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		iter->second.reconstructSubstitutedStates(solution);
+	}
+}
+
 void Model::deduceAppearanceDisappearanceStates(helpers::Solution& solution)
 {
 	// deduce states of appearance and disappearance variables
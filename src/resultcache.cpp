@@ -0,0 +1,163 @@
+#include "resultcache.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdint>
+
+namespace mht
+{
+
+namespace
+{
+
+/// 64 bit FNV-1a, which unlike std::hash gives the same value on every platform and compiler
+uint64_t hashString(const std::string& text, uint64_t hash = 14695981039346656037ULL)
+{
+	for(unsigned char c : text)
+	{
+		hash ^= c;
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+} // end anonymous namespace
+
+ResultCache::ResultCache(const std::string& directory, size_t maxSizeInBytes):
+	directory_(directory),
+	maxSizeInBytes_(maxSizeInBytes)
+{
+	if(directory_.empty())
+		throw std::runtime_error("The directory of the result cache must not be empty");
+	if(directory_.back() != '/')
+		directory_ += '/';
+	readIndex();
+}
+
+std::string ResultCache::computeKey(const Json::Value& model, const std::vector<double>& weights, const std::string& options)
+{
+	Json::Value weightsJson(Json::arrayValue);
+	for(double w : weights)
+		weightsJson.append(Json::Value(w));
+
+	// the fast writer prints members of objects in sorted order and doubles with full precision
+	Json::FastWriter writer;
+	std::string canonical = writer.write(model) + writer.write(weightsJson) + options;
+
+	// two hashes with different offsets make collisions practically impossible
+	std::stringstream key;
+	key << std::hex << std::setfill('0') << std::setw(16) << hashString(canonical)
+		<< std::setw(16) << hashString(canonical, hashString("result cache"));
+	return key.str();
+}
+
+std::string ResultCache::getEntryFilename(const std::string& key) const
+{
+	return directory_ + key + ".json";
+}
+
+std::string ResultCache::getIndexFilename() const
+{
+	return directory_ + "index.txt";
+}
+
+void ResultCache::readIndex()
+{
+	entries_.clear();
+	std::ifstream input(getIndexFilename().c_str());
+	if(!input.good())
+		return;
+
+	std::string key;
+	size_t size;
+	while(input >> key >> size)
+		entries_.push_back(std::make_pair(key, size));
+}
+
+void ResultCache::writeIndex() const
+{
+	// replace the index at once, so an interrupted write does not corrupt it
+	std::string temporaryFilename = getIndexFilename() + ".tmp";
+	{
+		std::ofstream output(temporaryFilename.c_str());
+		if(!output.good())
+			throw std::runtime_error("Could not write index of result cache in " + directory_);
+		for(auto& entry : entries_)
+			output << entry.first << " " << entry.second << "\n";
+	}
+	if(std::rename(temporaryFilename.c_str(), getIndexFilename().c_str()) != 0)
+		throw std::runtime_error("Could not replace index of result cache in " + directory_);
+}
+
+void ResultCache::removeEntry(std::list< std::pair<std::string, size_t> >::iterator entry)
+{
+	std::remove(getEntryFilename(entry->first).c_str());
+	entries_.erase(entry);
+}
+
+bool ResultCache::lookup(const std::string& key, Json::Value& result)
+{
+	for(auto iter = entries_.begin(); iter != entries_.end(); ++iter)
+	{
+		if(iter->first != key)
+			continue;
+
+		std::ifstream input(getEntryFilename(key).c_str());
+		Json::Reader reader;
+		if(!input.good() || !reader.parse(input, result))
+		{
+			// the file was deleted or is broken, forget about it
+			removeEntry(iter);
+			writeIndex();
+			return false;
+		}
+
+		entries_.splice(entries_.end(), entries_, iter);
+		writeIndex();
+		return true;
+	}
+	return false;
+}
+
+void ResultCache::store(const std::string& key, const Json::Value& result)
+{
+	std::string filename = getEntryFilename(key);
+	std::string temporaryFilename = filename + ".tmp";
+	size_t size = 0;
+	{
+		std::ofstream output(temporaryFilename.c_str());
+		if(!output.good())
+			throw std::runtime_error("Could not write result to cache: " + filename);
+		output << result << std::endl;
+		size = output.tellp();
+	}
+	if(std::rename(temporaryFilename.c_str(), filename.c_str()) != 0)
+		throw std::runtime_error("Could not write result to cache: " + filename);
+
+	for(auto iter = entries_.begin(); iter != entries_.end(); ++iter)
+	{
+		if(iter->first == key)
+		{
+			entries_.erase(iter);
+			break;
+		}
+	}
+	entries_.push_back(std::make_pair(key, size));
+
+	// delete the least recently used results, but always keep the new one
+	size_t totalSize = 0;
+	for(auto& entry : entries_)
+		totalSize += entry.second;
+	while(maxSizeInBytes_ > 0 && totalSize > maxSizeInBytes_ && entries_.size() > 1)
+	{
+		totalSize -= entries_.front().second;
+		removeEntry(entries_.begin());
+	}
+
+	writeIndex();
+}
+
+} // end namespace mht
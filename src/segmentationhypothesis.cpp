@@ -2,8 +2,10 @@
 #include "linkinghypothesis.h"
 #include "divisionhypothesis.h"
 #include "settings.h"
+#include "compactformulation.h"
 
 #include <stdexcept>
+#include <cmath>
 
 using namespace helpers;
 
@@ -51,8 +53,21 @@ void SegmentationHypothesis::toDot(std::ostream& stream, const Solution* sol) co
 	stream <<  "]; \n" << std::flush;
 }
 
+template<bool AllVariablesBinary>
 void SegmentationHypothesis::addIncomingConstraintToOpenGM(GraphicalModelType& model)
 {
+	if(appearance_.isSubstituted())
+	{
+		// the appearance is implicitly given as detection - sum(incoming) and only needs to stay within its range
+		std::map<size_t, double> appearanceValue;
+		addAppearanceValueTerms(appearanceValue, 1.0);
+		addValueConstraintToOpenGMModel(appearanceValue, 0, 
+			LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::GreaterEqual, model, AllVariablesBinary);
+		addValueConstraintToOpenGMModel(appearanceValue, appearance_.getNumStates() - 1, 
+			LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::LessEqual, model, AllVariablesBinary);
+		return;
+	}
+
 	// add constraint for sum of incoming = this label
 	LinearConstraintFunctionType::LinearConstraintType incomingConsistencyConstraint;
 	std::vector<LabelType> factorVariables;
@@ -62,7 +77,7 @@ void SegmentationHypothesis::addIncomingConstraintToOpenGM(GraphicalModelType& m
     for(size_t i = 0; i < incomingLinks_.size(); ++i)
     {
     	// indicator variable references the i+1'th argument of the constraint function, and its state 1
-    	addOpenGMVariableStateToConstraint(incomingConsistencyConstraint, incomingLinks_[i]->getVariable().getOpenGMVariableId(),
+    	addOpenGMVariableStateToConstraint<AllVariablesBinary>(incomingConsistencyConstraint, incomingLinks_[i]->getVariable().getOpenGMVariableId(),
     		1.0, constraintShape, factorVariables, model);
     }
 
@@ -70,29 +85,43 @@ void SegmentationHypothesis::addIncomingConstraintToOpenGM(GraphicalModelType& m
     for(size_t i = 0; i < incomingDivisions_.size(); ++i)
     {
     	// indicator variable references the i+1'th argument of the constraint function, and its state 1
-    	addOpenGMVariableStateToConstraint(incomingConsistencyConstraint, incomingDivisions_[i]->getVariable().getOpenGMVariableId(),
+    	addOpenGMVariableStateToConstraint<AllVariablesBinary>(incomingConsistencyConstraint, incomingDivisions_[i]->getVariable().getOpenGMVariableId(),
     		1.0, constraintShape, factorVariables, model);
     }
 
     // add this variable's state with negative coefficient
-	addOpenGMVariableStateToConstraint(incomingConsistencyConstraint, detection_.getOpenGMVariableId(),
+	addOpenGMVariableStateToConstraint<AllVariablesBinary>(incomingConsistencyConstraint, detection_.getOpenGMVariableId(),
 		-1.0, constraintShape, factorVariables, model);
 
     // add appearance with positive coefficient, if any
     if(appearance_.getOpenGMVariableId() >= 0)
     {
-    	addOpenGMVariableStateToConstraint(incomingConsistencyConstraint, appearance_.getOpenGMVariableId(),
+    	addOpenGMVariableStateToConstraint<AllVariablesBinary>(incomingConsistencyConstraint, appearance_.getOpenGMVariableId(),
     		1.0, constraintShape, factorVariables, model);
     }
 
-    incomingConsistencyConstraint.setBound( 0 );
+    // objects on fixed links outside of the model enter with a negative bound
+    incomingConsistencyConstraint.setBound( -double(fixedIncomingFlow_) );
     incomingConsistencyConstraint.setConstraintOperator(LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::Equal);
 
     addConstraintToOpenGMModel(incomingConsistencyConstraint, constraintShape, factorVariables, model);
 }
 
+template<bool AllVariablesBinary>
 void SegmentationHypothesis::addOutgoingConstraintToOpenGM(GraphicalModelType& model)
 {
+	if(disappearance_.isSubstituted())
+	{
+		// the disappearance is implicitly given as detection + division - sum(outgoing) and only needs to stay within its range
+		std::map<size_t, double> disappearanceValue;
+		addDisappearanceValueTerms(disappearanceValue, 1.0);
+		addValueConstraintToOpenGMModel(disappearanceValue, 0, 
+			LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::GreaterEqual, model, AllVariablesBinary);
+		addValueConstraintToOpenGMModel(disappearanceValue, disappearance_.getNumStates() - 1, 
+			LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::LessEqual, model, AllVariablesBinary);
+		return;
+	}
+
 	// add constraint for sum of ougoing = this label + division
 	LinearConstraintFunctionType::LinearConstraintType outgoingConsistencyConstraint;
 	std::vector<LabelType> factorVariables;
@@ -102,7 +131,7 @@ void SegmentationHypothesis::addOutgoingConstraintToOpenGM(GraphicalModelType& m
     for(size_t i = 0; i < outgoingLinks_.size(); ++i)
     {
     	// indicator variable references the i+2'nd argument of the constraint function, and its state 1
-        addOpenGMVariableStateToConstraint(outgoingConsistencyConstraint, outgoingLinks_[i]->getVariable().getOpenGMVariableId(),
+        addOpenGMVariableStateToConstraint<AllVariablesBinary>(outgoingConsistencyConstraint, outgoingLinks_[i]->getVariable().getOpenGMVariableId(),
     		1.0, constraintShape, factorVariables, model);
     }
 
@@ -110,25 +139,25 @@ void SegmentationHypothesis::addOutgoingConstraintToOpenGM(GraphicalModelType& m
     for(size_t i = 0; i < outgoingDivisions_.size(); ++i)
     {
     	// indicator variable references the i+1'th argument of the constraint function, and its state 1
-    	addOpenGMVariableStateToConstraint(outgoingConsistencyConstraint, outgoingDivisions_[i]->getVariable().getOpenGMVariableId(),
+    	addOpenGMVariableStateToConstraint<AllVariablesBinary>(outgoingConsistencyConstraint, outgoingDivisions_[i]->getVariable().getOpenGMVariableId(),
     		1.0, constraintShape, factorVariables, model);
     }
 
     // add this variable's state with negative coefficient
-    addOpenGMVariableStateToConstraint(outgoingConsistencyConstraint, detection_.getOpenGMVariableId(),
+    addOpenGMVariableStateToConstraint<AllVariablesBinary>(outgoingConsistencyConstraint, detection_.getOpenGMVariableId(),
 		-1.0, constraintShape, factorVariables, model);
 
 	// also the division node, if any
     if(division_.getOpenGMVariableId() >= 0)
     {
-    	addOpenGMVariableStateToConstraint(outgoingConsistencyConstraint, division_.getOpenGMVariableId(),
+    	addOpenGMVariableStateToConstraint<AllVariablesBinary>(outgoingConsistencyConstraint, division_.getOpenGMVariableId(),
     		-1.0, constraintShape, factorVariables, model);
     }
 
     // add appearance with positive coefficient, if any
     if(disappearance_.getOpenGMVariableId() >= 0)
     {
-    	addOpenGMVariableStateToConstraint(outgoingConsistencyConstraint, disappearance_.getOpenGMVariableId(),
+    	addOpenGMVariableStateToConstraint<AllVariablesBinary>(outgoingConsistencyConstraint, disappearance_.getOpenGMVariableId(),
     		1.0, constraintShape, factorVariables, model);
     }
 
@@ -138,6 +167,44 @@ void SegmentationHypothesis::addOutgoingConstraintToOpenGM(GraphicalModelType& m
     addConstraintToOpenGMModel(outgoingConsistencyConstraint, constraintShape, factorVariables, model);
 }
 
+void SegmentationHypothesis::addAppearanceValueTerms(std::map<size_t, double>& coefficients, double coefficient) const
+{
+	coefficients[detection_.getOpenGMVariableId()] += coefficient;
+	for(auto link : incomingLinks_)
+		coefficients[link->getVariable().getOpenGMVariableId()] -= coefficient;
+	for(auto division : incomingDivisions_)
+		coefficients[division->getVariable().getOpenGMVariableId()] -= coefficient;
+}
+
+void SegmentationHypothesis::addDisappearanceValueTerms(std::map<size_t, double>& coefficients, double coefficient) const
+{
+	coefficients[detection_.getOpenGMVariableId()] += coefficient;
+	if(division_.getOpenGMVariableId() >= 0)
+		coefficients[division_.getOpenGMVariableId()] += coefficient;
+	for(auto link : outgoingLinks_)
+		coefficients[link->getVariable().getOpenGMVariableId()] -= coefficient;
+	for(auto division : outgoingDivisions_)
+		coefficients[division->getVariable().getOpenGMVariableId()] -= coefficient;
+}
+
+void SegmentationHypothesis::addSubstitutedLengthOneConstraintToOpenGM(GraphicalModelType& model, bool allVariablesBinary)
+{
+	// both variables are binary if one of them is substituted, so their values equal their activity: appearance + disappearance <= 1
+	std::map<size_t, double> coefficients;
+	if(appearance_.isSubstituted())
+		addAppearanceValueTerms(coefficients, 1.0);
+	else
+		coefficients[appearance_.getOpenGMVariableId()] += 1.0;
+
+	if(disappearance_.isSubstituted())
+		addDisappearanceValueTerms(coefficients, 1.0);
+	else
+		coefficients[disappearance_.getOpenGMVariableId()] += 1.0;
+
+	addValueConstraintToOpenGMModel(coefficients, 1, 
+		LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::LessEqual, model, allVariablesBinary);
+}
+
 void SegmentationHypothesis::addDivisionConstraintToOpenGM(GraphicalModelType& model, bool requireSeparateChildren)
 {
 	if(division_.getOpenGMVariableId() < 0)
@@ -294,30 +361,40 @@ void SegmentationHypothesis::addToOpenGMModel(
 	const std::vector<size_t>& appearanceWeightIds,
 	const std::vector<size_t>& disappearanceWeightIds,
     bool useDivisionConstraint,
-    bool useMergerConstraint
+    bool useMergerConstraint,
+    bool precomputeUnaries,
+    bool allVariablesBinary
     )
 {
 	if(!settings)
 		throw std::runtime_error("Settings object cannot be nullptr");
 
-	detection_.addToOpenGM(model, settings->statesShareWeights_, weights, detectionWeightIds);
+	detection_.addToOpenGM(model, settings->statesShareWeights_, weights, detectionWeightIds, precomputeUnaries);
 	if(detection_.getOpenGMVariableId() < 0)
 		throw std::runtime_error("Detection variable must have some features!");
 
 	// only add division node if there are outgoing links
 	if(outgoingLinks_.size() > 1)
-		division_.addToOpenGM(model, settings->statesShareWeights_, weights, divisionWeightIds);
+		division_.addToOpenGM(model, settings->statesShareWeights_, weights, divisionWeightIds, precomputeUnaries);
 
-	appearance_.addToOpenGM(model, settings->statesShareWeights_, weights, appearanceWeightIds);
-	disappearance_.addToOpenGM(model, settings->statesShareWeights_, weights, disappearanceWeightIds);
+	appearance_.addToOpenGM(model, settings->statesShareWeights_, weights, appearanceWeightIds, precomputeUnaries);
+	disappearance_.addToOpenGM(model, settings->statesShareWeights_, weights, disappearanceWeightIds, precomputeUnaries);
 
 	sortByOpenGMVariableId(incomingLinks_);
 	sortByOpenGMVariableId(outgoingLinks_);
 	sortByOpenGMVariableId(incomingDivisions_);
 	sortByOpenGMVariableId(outgoingDivisions_);
 
-	addIncomingConstraintToOpenGM(model);
-	addOutgoingConstraintToOpenGM(model);
+	if(allVariablesBinary)
+	{
+		addIncomingConstraintToOpenGM<true>(model);
+		addOutgoingConstraintToOpenGM<true>(model);
+	}
+	else
+	{
+		addIncomingConstraintToOpenGM<false>(model);
+		addOutgoingConstraintToOpenGM<false>(model);
+	}
 
     if(useDivisionConstraint)
     {
@@ -329,7 +406,10 @@ void SegmentationHypothesis::addToOpenGMModel(
 
 	if(!settings->allowLengthOneTracks_)
 	{
-		addConstraintToOpenGM(model, appearance_.getOpenGMVariableId(), disappearance_.getOpenGMVariableId(), 0, 0, 1, 
+		if(appearance_.isSubstituted() || disappearance_.isSubstituted())
+			addSubstitutedLengthOneConstraintToOpenGM(model, allVariablesBinary);
+		else
+			addConstraintToOpenGM(model, appearance_.getOpenGMVariableId(), disappearance_.getOpenGMVariableId(), 0, 0, 1, 
 							  LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::GreaterEqual);
 	}
 
@@ -362,6 +442,324 @@ void SegmentationHypothesis::addToOpenGMModel(
 	}
 }
 
+void SegmentationHypothesis::countOpenGMModelSize(
+	OpenGMModelSize& size,
+	std::shared_ptr<Settings> settings,
+	bool useDivisionConstraint,
+	bool useMergerConstraint,
+	bool precomputeUnaries) const
+{
+	if(!settings)
+		throw std::runtime_error("Settings object cannot be nullptr");
+
+	bool hasDivision = outgoingLinks_.size() > 1 && division_.hasFeatures();
+	bool hasAppearance = appearance_.hasFeatures();
+	bool hasDisappearance = disappearance_.hasFeatures();
+
+	detection_.countOpenGMModelSize(size, settings->statesShareWeights_, precomputeUnaries);
+	if(hasDivision)
+		division_.countOpenGMModelSize(size, settings->statesShareWeights_, precomputeUnaries);
+	appearance_.countOpenGMModelSize(size, settings->statesShareWeights_, precomputeUnaries);
+	disappearance_.countOpenGMModelSize(size, settings->statesShareWeights_, precomputeUnaries);
+
+	// incoming and outgoing flow conservation, substituted variables need a lower and upper bound constraint instead
+	size_t numAppearanceValueVariables = incomingLinks_.size() + incomingDivisions_.size() + 1;
+	size_t numDisappearanceValueVariables = outgoingLinks_.size() + outgoingDivisions_.size() + 1 + (hasDivision ? 1 : 0);
+	if(appearance_.isSubstituted())
+	{
+		size.addConstraint(numAppearanceValueVariables);
+		size.addConstraint(numAppearanceValueVariables);
+	}
+	else
+		size.addConstraint(numAppearanceValueVariables + (hasAppearance ? 1 : 0));
+
+	if(disappearance_.isSubstituted())
+	{
+		size.addConstraint(numDisappearanceValueVariables);
+		size.addConstraint(numDisappearanceValueVariables);
+	}
+	else
+		size.addConstraint(numDisappearanceValueVariables + (hasDisappearance ? 1 : 0));
+
+	if(useDivisionConstraint && hasDivision)
+	{
+		size.addConstraint(2);
+		if(settings->requireSeparateChildrenOfDivision_)
+			size.addConstraint(outgoingLinks_.size() + 1);
+	}
+
+	// external divisions: one constraint per division plus one for allowing only one of them
+	for(size_t i = 0; i < outgoingDivisions_.size(); ++i)
+		size.addConstraint(2);
+	if(outgoingDivisions_.size() > 0)
+		size.addConstraint(outgoingDivisions_.size());
+
+	if(!settings->allowLengthOneTracks_ && hasAppearance && hasDisappearance)
+	{
+		if(appearance_.isSubstituted() && disappearance_.isSubstituted())
+			size.addConstraint(numAppearanceValueVariables + numDisappearanceValueVariables - 1); // detection appears in both
+		else if(appearance_.isSubstituted())
+			size.addConstraint(numAppearanceValueVariables + 1);
+		else if(disappearance_.isSubstituted())
+			size.addConstraint(numDisappearanceValueVariables + 1);
+		else
+			size.addConstraint(2);
+	}
+
+	if(useMergerConstraint && detection_.getNumStates() > 1)
+	{
+		if(hasAppearance && !settings->allowPartialMergerAppearance_)
+			for(size_t i = 0; i < incomingLinks_.size(); ++i)
+				size.addConstraint(2);
+
+		if(hasDisappearance)
+		{
+			if(!settings->allowPartialMergerAppearance_)
+				for(size_t i = 0; i < outgoingLinks_.size(); ++i)
+					size.addConstraint(2);
+
+			if(hasDivision)
+				size.addConstraint(2);
+		}
+	}
+}
+
+void SegmentationHypothesis::addToCompactFormulation(
+	CompactFormulation& formulation,
+	std::shared_ptr<Settings> settings,
+	bool useDivisionConstraint,
+	bool useMergerConstraint,
+	int lazyGroup)
+{
+	if(!settings)
+		throw std::runtime_error("Settings object cannot be nullptr");
+	if(detection_.getOpenGMVariableId() < 0)
+		throw std::runtime_error("Segmentation hypothesis must be added to the OpenGM model before building the compact formulation");
+
+	size_t detection = detection_.getOpenGMVariableId();
+	bool hasDivision = division_.getOpenGMVariableId() >= 0;
+	bool hasAppearance = appearance_.getOpenGMVariableId() >= 0;
+	bool hasDisappearance = disappearance_.getOpenGMVariableId() >= 0;
+
+	// flow conservation works on the values of the columns directly: sum(incoming) + appearance - detection = 0
+	CompactFormulation::RowType incoming;
+	for(auto link : incomingLinks_)
+		incoming.push_back(std::make_pair(link->getVariable().getOpenGMVariableId(), 1.0));
+	for(auto division : incomingDivisions_)
+		incoming.push_back(std::make_pair(division->getVariable().getOpenGMVariableId(), 1.0));
+	incoming.push_back(std::make_pair(detection, -1.0));
+	if(hasAppearance)
+		incoming.push_back(std::make_pair(appearance_.getOpenGMVariableId(), 1.0));
+	formulation.addRow(incoming, CompactFormulation::RowOperator::Equal, -double(fixedIncomingFlow_));
+
+	// sum(outgoing) + disappearance - detection - division = 0
+	CompactFormulation::RowType outgoing;
+	for(auto link : outgoingLinks_)
+		outgoing.push_back(std::make_pair(link->getVariable().getOpenGMVariableId(), 1.0));
+	for(auto division : outgoingDivisions_)
+		outgoing.push_back(std::make_pair(division->getVariable().getOpenGMVariableId(), 1.0));
+	outgoing.push_back(std::make_pair(detection, -1.0));
+	if(hasDivision)
+		outgoing.push_back(std::make_pair(division_.getOpenGMVariableId(), -1.0));
+	if(hasDisappearance)
+		outgoing.push_back(std::make_pair(disappearance_.getOpenGMVariableId(), 1.0));
+	formulation.addRow(outgoing, CompactFormulation::RowOperator::Equal, 0);
+
+	// division and merger constraints are the ones the cutting constraint scheme adds on demand
+	formulation.setLazyGroup(lazyGroup);
+
+	// a division requires the detection to take exactly state 1: division <= detection and detection + (M-1) * division <= M
+	if(useDivisionConstraint && hasDivision)
+	{
+		size_t division = formulation.getActivityColumn(division_.getOpenGMVariableId());
+		formulation.addRow({{division, 1.0}, {detection, -1.0}}, CompactFormulation::RowOperator::LessEqual, 0);
+		formulation.addAtMostOneIfActiveRow(detection, division);
+
+		// each child is a different link carrying one object, like 2*div[1] - sum_{t\in Outgoing} t[1] <= 0 of the indicator formulation.
+		// Flow conservation alone does not ensure two links, because the disappearance may carry one unit
+		if(settings->requireSeparateChildrenOfDivision_)
+		{
+			CompactFormulation::RowType separateChildren;
+			for(auto link : outgoingLinks_)
+			{
+				size_t linkColumn = link->getVariable().getOpenGMVariableId();
+				formulation.addAtMostOneIfActiveRow(linkColumn, division);
+				separateChildren.push_back(std::make_pair(formulation.getActivityColumn(linkColumn), 1.0));
+			}
+			separateChildren.push_back(std::make_pair(division, -2.0));
+			formulation.addRow(separateChildren, CompactFormulation::RowOperator::GreaterEqual, 0);
+		}
+	}
+
+	formulation.setLazyGroup(-1);
+
+	// same for external divisions, of which at most one may be active
+	CompactFormulation::RowType onlyOneDivision;
+	for(auto externalDivision : outgoingDivisions_)
+	{
+		size_t division = formulation.getActivityColumn(externalDivision->getVariable().getOpenGMVariableId());
+		formulation.addRow({{division, 1.0}, {detection, -1.0}}, CompactFormulation::RowOperator::LessEqual, 0);
+		formulation.addAtMostOneIfActiveRow(detection, division);
+		onlyOneDivision.push_back(std::make_pair(division, 1.0));
+	}
+	if(onlyOneDivision.size() > 0)
+		formulation.addRow(onlyOneDivision, CompactFormulation::RowOperator::LessEqual, 1);
+
+	auto addExclusion = [&](int openGMVarA, int openGMVarB){
+		if(openGMVarA < 0 || openGMVarB < 0)
+			return;
+		formulation.addRow({{formulation.getActivityColumn(openGMVarA), 1.0}, {formulation.getActivityColumn(openGMVarB), 1.0}}, 
+			CompactFormulation::RowOperator::LessEqual, 1);
+	};
+
+	if(!settings->allowLengthOneTracks_)
+		addExclusion(appearance_.getOpenGMVariableId(), disappearance_.getOpenGMVariableId());
+
+	formulation.setLazyGroup(lazyGroup);
+	if(useMergerConstraint && detection_.getNumStates() > 1)
+	{
+		if(hasAppearance && settings->allowPartialMergerAppearance_ == false)
+		{
+			for(auto link : incomingLinks_)
+				addExclusion(appearance_.getOpenGMVariableId(), link->getVariable().getOpenGMVariableId());
+		}
+
+		if(hasDisappearance)
+		{
+			if(settings->allowPartialMergerAppearance_ == false)
+			{
+				for(auto link : outgoingLinks_)
+					addExclusion(disappearance_.getOpenGMVariableId(), link->getVariable().getOpenGMVariableId());
+			}
+
+			addExclusion(disappearance_.getOpenGMVariableId(), division_.getOpenGMVariableId());
+		}
+	}
+	formulation.setLazyGroup(-1);
+}
+
+size_t SegmentationHypothesis::substituteAppearanceDisappearance(
+	const WeightsType& weights,
+	std::shared_ptr<Settings> settings,
+	const std::vector<size_t>& appearanceWeightIds,
+	const std::vector<size_t>& disappearanceWeightIds,
+	bool useMergerConstraint)
+{
+	if(!settings)
+		throw std::runtime_error("Settings object cannot be nullptr");
+	if(detection_.getOpenGMVariableId() >= 0)
+		throw std::runtime_error("Variables must be substituted before the segmentation hypothesis is added to the OpenGM model");
+
+	bool hasAppearance = appearance_.hasFeatures();
+	bool hasDisappearance = disappearance_.hasFeatures();
+	bool hasDivision = outgoingLinks_.size() > 1 && division_.hasFeatures();
+
+	// substitution only works if the energy is linear in the state: E(k) = E(0) + k * slope
+	auto isLinear = [](const std::vector<ValueType>& energies){
+		for(size_t state = 2; state < energies.size(); ++state)
+		{
+			ValueType expected = energies[0] + state * (energies[1] - energies[0]);
+			if(std::abs(energies[state] - expected) > 1e-9 * (1.0 + std::abs(expected)))
+				return false;
+		}
+		return true;
+	};
+
+	std::vector<ValueType> appearanceEnergies;
+	std::vector<ValueType> disappearanceEnergies;
+	bool substituteAppearance = false;
+	bool substituteDisappearance = false;
+
+	if(hasAppearance)
+	{
+		appearanceEnergies = appearance_.computeEnergies(settings->statesShareWeights_, weights, appearanceWeightIds);
+		substituteAppearance = appearanceEnergies.size() > 1 && isLinear(appearanceEnergies);
+	}
+	if(hasDisappearance)
+	{
+		disappearanceEnergies = disappearance_.computeEnergies(settings->statesShareWeights_, weights, disappearanceWeightIds);
+		substituteDisappearance = disappearanceEnergies.size() > 1 && isLinear(disappearanceEnergies);
+	}
+
+	// merger constraints need the activity of the appearance/disappearance variables, which the flow does not provide
+	if(useMergerConstraint && detection_.getNumStates() > 1)
+	{
+		if(!settings->allowPartialMergerAppearance_)
+		{
+			substituteAppearance = false;
+			substituteDisappearance = false;
+		}
+		if(hasDivision)
+			substituteDisappearance = false;
+	}
+
+	// the range constraints of a substituted appearance do not know about objects on fixed links
+	if(fixedIncomingFlow_ > 0)
+		substituteAppearance = false;
+
+	// forbidding length one tracks can be expressed in the substituted values only if they equal the activities
+	if(!settings->allowLengthOneTracks_ && hasAppearance && hasDisappearance 
+		&& (appearance_.getNumStates() > 2 || disappearance_.getNumStates() > 2))
+	{
+		substituteAppearance = false;
+		substituteDisappearance = false;
+	}
+
+	// appearance = detection - sum(incoming), so its energy E(0) + slope * appearance is moved to the detection and the incoming links
+	if(substituteAppearance)
+	{
+		ValueType slope = appearanceEnergies[1] - appearanceEnergies[0];
+		detection_.addEnergyOffset(appearanceEnergies[0], slope);
+		for(auto link : incomingLinks_)
+			link->getVariable().addEnergyOffset(0.0, -slope);
+		for(auto division : incomingDivisions_)
+			division->getVariable().addEnergyOffset(0.0, -slope);
+		appearance_.setSubstituted();
+	}
+
+	// disappearance = detection + division - sum(outgoing)
+	if(substituteDisappearance)
+	{
+		ValueType slope = disappearanceEnergies[1] - disappearanceEnergies[0];
+		detection_.addEnergyOffset(disappearanceEnergies[0], slope);
+		if(hasDivision)
+			division_.addEnergyOffset(0.0, slope);
+		for(auto link : outgoingLinks_)
+			link->getVariable().addEnergyOffset(0.0, -slope);
+		for(auto division : outgoingDivisions_)
+			division->getVariable().addEnergyOffset(0.0, -slope);
+		disappearance_.setSubstituted();
+	}
+
+	return (substituteAppearance ? 1 : 0) + (substituteDisappearance ? 1 : 0);
+}
+
+void SegmentationHypothesis::assignSubstitutedVariableIds(size_t& nextVariableId)
+{
+	if(appearance_.isSubstituted())
+		appearance_.setSubstitutedVariableId(nextVariableId++);
+	if(disappearance_.isSubstituted())
+		disappearance_.setSubstitutedVariableId(nextVariableId++);
+}
+
+void SegmentationHypothesis::reconstructSubstitutedStates(Solution& sol) const
+{
+	size_t detectionValue = sol[detection_.getOpenGMVariableId()];
+
+	if(appearance_.isSubstituted())
+	{
+		size_t sumIncoming = getNumActiveIncomingLinks(sol);
+		sol[appearance_.getOpenGMVariableId()] = detectionValue > sumIncoming ? detectionValue - sumIncoming : 0;
+	}
+
+	if(disappearance_.isSubstituted())
+	{
+		size_t divisionValue = division_.getOpenGMVariableId() >= 0 ? sol[division_.getOpenGMVariableId()] : 0;
+		size_t sumOutgoing = getNumActiveOutgoingLinks(sol);
+		sol[disappearance_.getOpenGMVariableId()] = detectionValue + divisionValue > sumOutgoing ? detectionValue + divisionValue - sumOutgoing : 0;
+	}
+}
+
 void SegmentationHypothesis::addDivisionConstraint(helpers::GraphicalModelType& model, bool requireSeparateChildren)
 {
     addDivisionConstraintToOpenGM(model, requireSeparateChildren);
@@ -430,7 +828,7 @@ void SegmentationHypothesis::addOutgoingDivision(std::shared_ptr<DivisionHypothe
 
 size_t SegmentationHypothesis::getNumActiveIncomingLinks(const Solution& sol) const
 {
-	size_t sum = 0;
+	size_t sum = fixedIncomingFlow_;
 	for(auto link : incomingLinks_)
 	{
 		if(link->getVariable().getOpenGMVariableId() < 0)
@@ -489,7 +887,7 @@ bool SegmentationHypothesis::verifySolution(const Solution& sol, const std::shar
 		sumIncoming += sol[appearance_.getOpenGMVariableId()];
 	}
 
-	if(incomingLinks_.size() > 0 && sumIncoming != ownValue)
+	if((incomingLinks_.size() > 0 || fixedIncomingFlow_ > 0) && sumIncoming != ownValue)
 	{
 		// std::cout << "At node " << id_ << ": incoming=" << sumIncoming << " is NOT EQUAL to " << ownValue << std::endl;
 		// std::cout << "(division = " << divisionValue << ")" << std::endl;
@@ -518,7 +916,7 @@ bool SegmentationHypothesis::verifySolution(const Solution& sol, const std::shar
 
 	//--------------------------------
 	// check no length one tracks
-	if(settings->allowLengthOneTracks_)
+	if(!settings->allowLengthOneTracks_ && appearance_.getOpenGMVariableId() >= 0 && disappearance_.getOpenGMVariableId() >= 0)
 	{
 		if(sol[appearance_.getOpenGMVariableId()] > 0 && sol[disappearance_.getOpenGMVariableId()] > 0)
 		{
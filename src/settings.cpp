@@ -11,7 +11,18 @@ Settings::Settings():
 	optimizerEpGap_(0.01),
 	optimizerVerbose_(true),
 	optimizerNumThreads_(1),
-	nonNegativeWeightsOnly_(false)
+	nonNegativeWeightsOnly_(false),
+	mergeExclusionCliques_(false),
+	useCompactFormulation_(false),
+	substituteAppearanceDisappearance_(false),
+	useMinCostFlowSolver_(true),
+	useGreedyStartingPoint_(true),
+	useLazyConstraints_(false),
+	lazyExclusionConstraints_(false),
+	useDynamicProgramming_(true),
+	optimizerTimeLimit_(0.0),
+	lookBackHorizon_(3),
+	roundRelaxedSolution_(false)
 {}
 
 Settings::Settings(const Json::Value& entry)
@@ -55,6 +66,61 @@ Settings::Settings(const Json::Value& entry)
 		nonNegativeWeightsOnly_ = entry[JsonTypeNames[JsonTypes::NonNegativeWeightsOnly]].asBool();
 	else 
 		nonNegativeWeightsOnly_ = false;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::MergeExclusionCliques]))
+		mergeExclusionCliques_ = entry[JsonTypeNames[JsonTypes::MergeExclusionCliques]].asBool();
+	else 
+		mergeExclusionCliques_ = false;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::UseCompactFormulation]))
+		useCompactFormulation_ = entry[JsonTypeNames[JsonTypes::UseCompactFormulation]].asBool();
+	else 
+		useCompactFormulation_ = false;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::SubstituteAppearanceDisappearance]))
+		substituteAppearanceDisappearance_ = entry[JsonTypeNames[JsonTypes::SubstituteAppearanceDisappearance]].asBool();
+	else 
+		substituteAppearanceDisappearance_ = false;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::UseMinCostFlowSolver]))
+		useMinCostFlowSolver_ = entry[JsonTypeNames[JsonTypes::UseMinCostFlowSolver]].asBool();
+	else 
+		useMinCostFlowSolver_ = true;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::UseGreedyStartingPoint]))
+		useGreedyStartingPoint_ = entry[JsonTypeNames[JsonTypes::UseGreedyStartingPoint]].asBool();
+	else 
+		useGreedyStartingPoint_ = true;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::UseLazyConstraints]))
+		useLazyConstraints_ = entry[JsonTypeNames[JsonTypes::UseLazyConstraints]].asBool();
+	else 
+		useLazyConstraints_ = false;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::LazyExclusionConstraints]))
+		lazyExclusionConstraints_ = entry[JsonTypeNames[JsonTypes::LazyExclusionConstraints]].asBool();
+	else 
+		lazyExclusionConstraints_ = false;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::UseDynamicProgramming]))
+		useDynamicProgramming_ = entry[JsonTypeNames[JsonTypes::UseDynamicProgramming]].asBool();
+	else 
+		useDynamicProgramming_ = true;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::OptimizerTimeLimit]))
+		optimizerTimeLimit_ = entry[JsonTypeNames[JsonTypes::OptimizerTimeLimit]].asDouble();
+	else 
+		optimizerTimeLimit_ = 0.0;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::LookBackHorizon]))
+		lookBackHorizon_ = entry[JsonTypeNames[JsonTypes::LookBackHorizon]].asUInt();
+	else 
+		lookBackHorizon_ = 3;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::RoundRelaxedSolution]))
+		roundRelaxedSolution_ = entry[JsonTypeNames[JsonTypes::RoundRelaxedSolution]].asBool();
+	else 
+		roundRelaxedSolution_ = false;
 }
 
 void Settings::saveToJson(Json::Value& entry)
@@ -67,6 +133,17 @@ void Settings::saveToJson(Json::Value& entry)
 	entry[JsonTypeNames[JsonTypes::OptimizerEpGap]] = Json::Value(optimizerEpGap_);
 	entry[JsonTypeNames[JsonTypes::OptimizerVerbose]] = Json::Value(optimizerVerbose_);
 	entry[JsonTypeNames[JsonTypes::OptimizerNumThreads]] = Json::Value((int)optimizerNumThreads_);
+	entry[JsonTypeNames[JsonTypes::MergeExclusionCliques]] = Json::Value(mergeExclusionCliques_);
+	entry[JsonTypeNames[JsonTypes::UseCompactFormulation]] = Json::Value(useCompactFormulation_);
+	entry[JsonTypeNames[JsonTypes::SubstituteAppearanceDisappearance]] = Json::Value(substituteAppearanceDisappearance_);
+	entry[JsonTypeNames[JsonTypes::UseMinCostFlowSolver]] = Json::Value(useMinCostFlowSolver_);
+	entry[JsonTypeNames[JsonTypes::UseGreedyStartingPoint]] = Json::Value(useGreedyStartingPoint_);
+	entry[JsonTypeNames[JsonTypes::UseLazyConstraints]] = Json::Value(useLazyConstraints_);
+	entry[JsonTypeNames[JsonTypes::LazyExclusionConstraints]] = Json::Value(lazyExclusionConstraints_);
+	entry[JsonTypeNames[JsonTypes::UseDynamicProgramming]] = Json::Value(useDynamicProgramming_);
+	entry[JsonTypeNames[JsonTypes::OptimizerTimeLimit]] = Json::Value(optimizerTimeLimit_);
+	entry[JsonTypeNames[JsonTypes::LookBackHorizon]] = Json::Value((unsigned int)lookBackHorizon_);
+	entry[JsonTypeNames[JsonTypes::RoundRelaxedSolution]] = Json::Value(roundRelaxedSolution_);
 }
 
 void Settings::print()
@@ -81,6 +158,17 @@ void Settings::print()
 		<< "\n\tOptimizerEpGap: " << optimizerEpGap_
 		<< "\n\tOptimizerVerbose: " << (optimizerVerbose_ ? "true" : "false")
 		<< "\n\tOptimizerNumThreads: " << optimizerNumThreads_
+		<< "\n\tMergeExclusionCliques: " << (mergeExclusionCliques_ ? "true" : "false")
+		<< "\n\tUseCompactFormulation: " << (useCompactFormulation_ ? "true" : "false")
+		<< "\n\tSubstituteAppearanceDisappearance: " << (substituteAppearanceDisappearance_ ? "true" : "false")
+		<< "\n\tUseMinCostFlowSolver: " << (useMinCostFlowSolver_ ? "true" : "false")
+		<< "\n\tUseGreedyStartingPoint: " << (useGreedyStartingPoint_ ? "true" : "false")
+		<< "\n\tUseLazyConstraints: " << (useLazyConstraints_ ? "true" : "false")
+		<< "\n\tLazyExclusionConstraints: " << (lazyExclusionConstraints_ ? "true" : "false")
+		<< "\n\tUseDynamicProgramming: " << (useDynamicProgramming_ ? "true" : "false")
+		<< "\n\tOptimizerTimeLimit: " << optimizerTimeLimit_
+		<< "\n\tLookBackHorizon: " << lookBackHorizon_
+		<< "\n\tRoundRelaxedSolution: " << (roundRelaxedSolution_ ? "true" : "false")
 		<< "\n************************"
 		<< std::endl;
 }
@@ -0,0 +1,290 @@
+#include "treedynamicprogram.h"
+
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+using namespace helpers;
+
+namespace mht
+{
+
+size_t TreeDynamicProgram::addNode(
+	const std::vector<ValueType>& detectionEnergies,
+	const std::vector<ValueType>& appearanceEnergies,
+	const std::vector<ValueType>& disappearanceEnergies,
+	const std::vector<ValueType>& divisionEnergies,
+	const NodeConstraints& constraints)
+{
+	if(detectionEnergies.empty())
+		throw std::runtime_error("Every node of the dynamic program needs a detection variable");
+
+	Node node;
+	node.energies[Detection] = detectionEnergies;
+	node.energies[Appearance] = appearanceEnergies;
+	node.energies[Disappearance] = disappearanceEnergies;
+	node.energies[Division] = divisionEnergies;
+	node.constraints = constraints;
+	nodes_.push_back(node);
+	return nodes_.size() - 1;
+}
+
+size_t TreeDynamicProgram::addArc(size_t from, size_t to, const std::vector<ValueType>& energies)
+{
+	if(from >= nodes_.size() || to >= nodes_.size())
+		throw std::runtime_error("Cannot add arc between nodes that are not part of the dynamic program");
+	if(energies.empty())
+		throw std::runtime_error("Every arc of the dynamic program needs energies");
+
+	Arc arc;
+	arc.from = from;
+	arc.to = to;
+	arc.energies = energies;
+	arcs_.push_back(arc);
+	nodes_[from].arcs.push_back(arcs_.size() - 1);
+	nodes_[to].arcs.push_back(arcs_.size() - 1);
+	return arcs_.size() - 1;
+}
+
+ValueType TreeDynamicProgram::solve()
+{
+	// root every tree of the forest and order the nodes such that children come after their parents
+	std::vector<size_t> order;
+	std::vector<bool> visited(nodes_.size(), false);
+	std::vector<size_t> roots;
+	for(size_t root = 0; root < nodes_.size(); ++root)
+	{
+		if(visited[root])
+			continue;
+
+		roots.push_back(root);
+		visited[root] = true;
+		nodes_[root].parentArc = -1;
+		size_t first = order.size();
+		order.push_back(root);
+		for(size_t i = first; i < order.size(); ++i)
+		{
+			Node& node = nodes_[order[i]];
+			node.incomingChildArcs.clear();
+			node.outgoingChildArcs.clear();
+			for(size_t a : node.arcs)
+			{
+				if((int)a == node.parentArc)
+					continue;
+
+				size_t neighbor = arcs_[a].from == order[i] ? arcs_[a].to : arcs_[a].from;
+				if(visited[neighbor])
+					throw std::runtime_error("The arcs of the dynamic program must not contain cycles");
+
+				visited[neighbor] = true;
+				nodes_[neighbor].parentArc = a;
+				order.push_back(neighbor);
+				if(arcs_[a].to == order[i])
+					node.incomingChildArcs.push_back(a);
+				else
+					node.outgoingChildArcs.push_back(a);
+			}
+		}
+	}
+
+	for(auto it = order.rbegin(); it != order.rend(); ++it)
+		solveNode(*it);
+
+	ValueType totalEnergy = 0.0;
+	for(size_t root : roots)
+	{
+		if(nodes_[root].subtreeEnergies[0] == std::numeric_limits<ValueType>::infinity())
+			throw std::runtime_error("The constraints of the dynamic program cannot be satisfied");
+		totalEnergy += nodes_[root].subtreeEnergies[0];
+	}
+
+	for(size_t n : order)
+	{
+		const Node& node = nodes_[n];
+		backtrackNode(n, node.parentArc < 0 ? 0 : arcs_[node.parentArc].state);
+	}
+
+	return totalEnergy;
+}
+
+void TreeDynamicProgram::solveNode(size_t n)
+{
+	const ValueType infinity = std::numeric_limits<ValueType>::infinity();
+	Node& node = nodes_[n];
+
+	size_t numDetectionStates = numStates(node.energies[Detection]);
+	size_t numDivisionStates = numStates(node.energies[Division]);
+	size_t maxIncoming = numDetectionStates - 1;
+	size_t maxOutgoing = numDetectionStates + numDivisionStates - 2;
+
+	// energy of a child arc in the given state, including the subtree behind it
+	auto childEnergy = [&](size_t a, size_t state) -> ValueType {
+		const Arc& arc = arcs_[a];
+		const Node& child = nodes_[arc.from == n ? arc.to : arc.from];
+		return arc.energies[state] + child.subtreeEnergies[state];
+	};
+
+	// knapsack over the incoming child arcs: minimal energy for each sum of their flows
+	std::vector<ValueType> incoming(maxIncoming + 1, infinity);
+	incoming[0] = 0.0;
+	node.incomingFlows.assign(node.incomingChildArcs.size(), std::vector<size_t>(maxIncoming + 1, 0));
+	for(size_t stage = 0; stage < node.incomingChildArcs.size(); ++stage)
+	{
+		size_t a = node.incomingChildArcs[stage];
+		std::vector<ValueType> next(maxIncoming + 1, infinity);
+		for(size_t sum = 0; sum <= maxIncoming; ++sum)
+		{
+			if(incoming[sum] == infinity)
+				continue;
+			for(size_t flow = 0; flow < arcs_[a].energies.size() && sum + flow <= maxIncoming; ++flow)
+			{
+				ValueType e = incoming[sum] + childEnergy(a, flow);
+				if(e < next[sum + flow])
+				{
+					next[sum + flow] = e;
+					node.incomingFlows[stage][sum + flow] = flow;
+				}
+			}
+		}
+		incoming.swap(next);
+	}
+
+	// knapsack over the outgoing child arcs, which also counts the arcs in state 1 (up to two) for the separate children constraint
+	const size_t maxOnes = 2;
+	std::vector< std::vector<ValueType> > outgoing(maxOutgoing + 1, std::vector<ValueType>(maxOnes + 1, infinity));
+	outgoing[0][0] = 0.0;
+	node.outgoingFlows.assign(node.outgoingChildArcs.size(), std::vector< std::pair<size_t, size_t> >((maxOutgoing + 1) * (maxOnes + 1)));
+	for(size_t stage = 0; stage < node.outgoingChildArcs.size(); ++stage)
+	{
+		size_t a = node.outgoingChildArcs[stage];
+		std::vector< std::vector<ValueType> > next(maxOutgoing + 1, std::vector<ValueType>(maxOnes + 1, infinity));
+		for(size_t sum = 0; sum <= maxOutgoing; ++sum)
+		{
+			for(size_t ones = 0; ones <= maxOnes; ++ones)
+			{
+				if(outgoing[sum][ones] == infinity)
+					continue;
+				for(size_t flow = 0; flow < arcs_[a].energies.size() && sum + flow <= maxOutgoing; ++flow)
+				{
+					size_t nextOnes = std::min(maxOnes, ones + (flow == 1 ? 1 : 0));
+					ValueType e = outgoing[sum][ones] + childEnergy(a, flow);
+					if(e < next[sum + flow][nextOnes])
+					{
+						next[sum + flow][nextOnes] = e;
+						node.outgoingFlows[stage][(sum + flow) * (maxOnes + 1) + nextOnes] = std::make_pair(flow, ones);
+					}
+				}
+			}
+		}
+		outgoing.swap(next);
+	}
+
+	// combine with the node's own variables for every state of the parent arc
+	bool parentIsIncoming = node.parentArc >= 0 && arcs_[node.parentArc].to == n;
+	size_t numParentStates = node.parentArc >= 0 ? arcs_[node.parentArc].energies.size() : 1;
+	node.subtreeEnergies.assign(numParentStates, infinity);
+	node.choices.assign(numParentStates, Choice());
+
+	const NodeConstraints& constraints = node.constraints;
+	bool hasAppearance = !node.energies[Appearance].empty();
+	bool hasDisappearance = !node.energies[Disappearance].empty();
+	bool hasDivision = !node.energies[Division].empty();
+
+	for(size_t parentState = 0; parentState < numParentStates; ++parentState)
+	{
+		size_t parentIncoming = parentIsIncoming ? parentState : 0;
+		size_t parentOutgoing = parentIsIncoming ? 0 : parentState;
+
+		for(size_t detection = 0; detection < numDetectionStates; ++detection)
+		for(size_t appearance = 0; appearance < numStates(node.energies[Appearance]); ++appearance)
+		{
+			// incoming: sum(incoming) + appearance = detection
+			if(parentIncoming + appearance + constraints.fixedIncomingFlow > detection)
+				continue;
+			size_t incomingSum = detection - appearance - parentIncoming - constraints.fixedIncomingFlow;
+			if(incoming[incomingSum] == infinity)
+				continue;
+			if(constraints.noPartialMergerAppearance && hasAppearance && appearance > 0 
+				&& incomingSum + parentIncoming + constraints.fixedIncomingFlow > 0)
+				continue;
+
+			for(size_t division = 0; division < numDivisionStates; ++division)
+			for(size_t disappearance = 0; disappearance < numStates(node.energies[Disappearance]); ++disappearance)
+			{
+				// outgoing: sum(outgoing) + disappearance = detection + division
+				if(parentOutgoing + disappearance > detection + division)
+					continue;
+				size_t outgoingSum = detection + division - disappearance - parentOutgoing;
+				if(outgoingSum > maxOutgoing)
+					continue;
+
+				if(constraints.division && hasDivision && division == 1 && detection != 1)
+					continue;
+				if(constraints.noLengthOneTracks && hasAppearance && hasDisappearance && appearance > 0 && disappearance > 0)
+					continue;
+				if(constraints.noPartialMergerAppearance && hasDisappearance && disappearance > 0 && outgoingSum + parentOutgoing > 0)
+					continue;
+				if(constraints.noDisappearanceWithDivision && hasDisappearance && hasDivision && disappearance > 0 && division > 0)
+					continue;
+
+				ValueType ownEnergy = energy(node.energies[Detection], detection) + energy(node.energies[Appearance], appearance)
+					+ energy(node.energies[Disappearance], disappearance) + energy(node.energies[Division], division)
+					+ incoming[incomingSum];
+
+				for(size_t ones = 0; ones <= maxOnes; ++ones)
+				{
+					if(outgoing[outgoingSum][ones] == infinity)
+						continue;
+
+					// 2 * division[1] <= number of outgoing links in state 1
+					size_t totalOnes = ones + (parentOutgoing == 1 ? 1 : 0);
+					if(constraints.division && constraints.separateChildren && hasDivision && division == 1 && totalOnes < 2)
+						continue;
+
+					ValueType e = ownEnergy + outgoing[outgoingSum][ones];
+					if(e < node.subtreeEnergies[parentState])
+					{
+						node.subtreeEnergies[parentState] = e;
+						Choice& choice = node.choices[parentState];
+						choice.states[Detection] = detection;
+						choice.states[Appearance] = appearance;
+						choice.states[Disappearance] = disappearance;
+						choice.states[Division] = division;
+						choice.incomingSum = incomingSum;
+						choice.outgoingSum = outgoingSum;
+						choice.numOutgoingOnes = ones;
+					}
+				}
+			}
+		}
+	}
+}
+
+void TreeDynamicProgram::backtrackNode(size_t n, size_t parentState)
+{
+	Node& node = nodes_[n];
+	const Choice& choice = node.choices[parentState];
+	std::copy(choice.states, choice.states + NumVariableTypes, node.states);
+
+	// walk the knapsacks backwards to find the state of every child arc
+	size_t sum = choice.incomingSum;
+	for(size_t stage = node.incomingChildArcs.size(); stage-- > 0;)
+	{
+		size_t flow = node.incomingFlows[stage][sum];
+		arcs_[node.incomingChildArcs[stage]].state = flow;
+		sum -= flow;
+	}
+
+	const size_t maxOnes = 2;
+	sum = choice.outgoingSum;
+	size_t ones = choice.numOutgoingOnes;
+	for(size_t stage = node.outgoingChildArcs.size(); stage-- > 0;)
+	{
+		const std::pair<size_t, size_t>& entry = node.outgoingFlows[stage][sum * (maxOnes + 1) + ones];
+		arcs_[node.outgoingChildArcs[stage]].state = entry.first;
+		sum -= entry.first;
+		ones = entry.second;
+	}
+}
+
+} // end namespace mht
@@ -12,19 +12,36 @@ void Variable::addToOpenGM(
 	GraphicalModelType& model, 
 	bool statesShareWeights,
 	WeightsType& weights, 
-	const std::vector<size_t>& weightIds)
+	const std::vector<size_t>& weightIds,
+	bool precomputeUnaries)
 {
-	// only add variable if there are any features
-	if(features_.size() == 0 || features_[0].size() == 0)
+	// only add variable if there are any features and it is not determined by others
+	if(!hasFeatures() || substituted_)
 		return;
 
+	if(!precomputeUnaries && (constantEnergyOffset_ != 0.0 || energyOffsetPerValue_ != 0.0))
+		throw std::runtime_error("Energy offsets of substituted variables require precomputed unaries");
+
 	// Add variable to model. All Variables are binary!
 	size_t numStates = getNumStates();
 	model.addVariable(numStates);
 	openGMVariableId_ = model.numberOfVariables() - 1;
+	hasExplicitUnary_ = precomputeUnaries;
 	assert((int)weightIds.size() == getNumWeights(statesShareWeights));
 
-	if(statesShareWeights)
+	if(precomputeUnaries)
+	{
+		// weights are fixed, so we can store the energies directly instead of the features
+		std::vector<ValueType> energies = computeEnergies(statesShareWeights, weights, weightIds);
+		std::vector<size_t> functionShape(1, numStates);
+		ExplicitFunctionType unary(functionShape.begin(), functionShape.end(), 0.0);
+		for(size_t state = 0; state < numStates; ++state)
+			unary(state) = energies[state];
+
+		explicitUnaryFunctionId_ = model.addFunction(unary);
+		openGMUnaryFactorId_ = model.addFactor(explicitUnaryFunctionId_, &openGMVariableId_, &openGMVariableId_+1);
+	}
+	else if(statesShareWeights)
 	{
 		// if we want to use the weights more than once, the construction is a bit more involved than in the else-branch
 		size_t numFeatures = features_[0].size();
@@ -48,7 +65,7 @@ void Variable::addToOpenGM(
 	    std::vector<size_t> functionShape(1, numStates);
 	    LearnableWeightedSumOfFuncType unary(functionShape, weights, weightIds, features);
 		GraphicalModelType::FunctionIdentifier fid = model.addFunction(unary);
-		model.addFactor(fid, &openGMVariableId_, &openGMVariableId_+1);
+		openGMUnaryFactorId_ = model.addFactor(fid, &openGMVariableId_, &openGMVariableId_+1);
 	}
 	else
 	{
@@ -62,7 +79,7 @@ void Variable::addToOpenGM(
 		{
 			FeaturesAndIndicesType featureAndIndex;
 
-			featureAndIndex.features = features_[state];
+			featureAndIndex.features.assign(features_[state].begin(), features_[state].end());
 			for(size_t i = 0; i < features_[state].size(); ++i)
 			{
 				featureAndIndex.weightIds.push_back(weightIds[weightIdx++]);
@@ -73,8 +90,75 @@ void Variable::addToOpenGM(
 
 		LearnableUnaryFuncType unary(weights, featuresAndWeightsPerLabel);
 		GraphicalModelType::FunctionIdentifier fid = model.addFunction(unary);
-		model.addFactor(fid, &openGMVariableId_, &openGMVariableId_+1);
+		openGMUnaryFactorId_ = model.addFactor(fid, &openGMVariableId_, &openGMVariableId_+1);
+	}
+}
+
+void Variable::countOpenGMModelSize(OpenGMModelSize& size, bool statesShareWeights, bool precomputeUnaries) const
+{
+	if(!hasFeatures() || substituted_)
+		return;
+
+	size.numVariables++;
+	size.numFactorVariables++;
+
+	if(precomputeUnaries)
+		size.numExplicitUnaries++;
+	else if(statesShareWeights)
+		size.numLearnableWeightedSums++;
+	else
+		size.numLearnableUnaries++;
+}
+
+std::vector<ValueType> Variable::computeEnergies(
+	bool statesShareWeights,
+	const WeightsType& weights, 
+	const std::vector<size_t>& weightIds) const
+{
+	size_t numStates = getNumStates();
+	std::vector<ValueType> energies(numStates, 0.0);
+
+	// if weights are not shared over states, the weight index keeps running over all states
+	size_t weightIdx = 0;
+	for(size_t state = 0; state < numStates; ++state)
+	{
+		if(statesShareWeights)
+			weightIdx = 0;
+
+		const FeatureVector& stateFeatures = features_[state];
+		ValueType energy = 0.0;
+		for(size_t i = 0; i < stateFeatures.size(); ++i)
+			energy += weights.getWeight(weightIds[weightIdx++]) * stateFeatures[i];
+		energies[state] = energy + constantEnergyOffset_ + energyOffsetPerValue_ * state;
 	}
+
+	return energies;
+}
+
+std::vector<ValueType> Variable::getOpenGMEnergies(const GraphicalModelType& model) const
+{
+	std::vector<ValueType> energies;
+	if(openGMUnaryFactorId_ < 0)
+		return energies;
+
+	for(LabelType state = 0; state < getNumStates(); ++state)
+		energies.push_back(model[openGMUnaryFactorId_](&state));
+
+	return energies;
+}
+
+void Variable::setOpenGMEnergies(GraphicalModelType& model, const std::vector<ValueType>& energies) const
+{
+	if(openGMUnaryFactorId_ < 0)
+		return;
+	if(!hasExplicitUnary_)
+		throw std::runtime_error("Only precomputed unaries of the opengm model can be overwritten");
+	if(energies.size() != getNumStates())
+		throw std::runtime_error("Need the energy of every state to overwrite the unary of a variable");
+
+	ExplicitFunctionType& unary = model.getFunction<ExplicitFunctionType>(explicitUnaryFunctionId_);
+	for(size_t state = 0; state < energies.size(); ++state)
+		unary(state) = energies[state];
 }
 
 const int Variable::getNumWeights(bool statesShareWeights) const
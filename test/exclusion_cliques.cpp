@@ -0,0 +1,70 @@
+#define BOOST_TEST_MODULE exclusion_cliques
+
+#include <iostream>
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "helpers.h"
+#include "exclusionconstraint.h"
+
+using namespace mht;
+using namespace helpers;
+
+namespace
+{
+
+ExclusionConstraint makeConstraint(const std::vector<int>& ids)
+{
+	std::vector<IdLabelType> labels;
+	for(int id : ids)
+		labels.push_back(boost::lexical_cast<IdLabelType>(id));
+	return ExclusionConstraint(labels);
+}
+
+std::vector<IdLabelType> sortedIds(const ExclusionConstraint& constraint)
+{
+	std::vector<IdLabelType> ids = constraint.getIds();
+	std::sort(ids.begin(), ids.end());
+	return ids;
+}
+
+} // end anonymous namespace
+
+BOOST_AUTO_TEST_CASE( MergeTriangleIntoOneClique )
+{
+	std::vector<ExclusionConstraint> constraints = {makeConstraint({1, 2}), makeConstraint({2, 3}), makeConstraint({1, 3})};
+	std::vector<ExclusionConstraint> cliques = ExclusionConstraint::mergeIntoCliques(constraints);
+
+	BOOST_CHECK_EQUAL(cliques.size(), 1);
+	std::vector<IdLabelType> expected = makeConstraint({1, 2, 3}).getIds();
+	std::sort(expected.begin(), expected.end());
+	std::vector<IdLabelType> ids = sortedIds(cliques[0]);
+	BOOST_CHECK_EQUAL_COLLECTIONS(ids.begin(), ids.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE( MergeKeepsPathEdges )
+{
+	// 1 and 3 do not conflict, so the path must not become a clique
+	std::vector<ExclusionConstraint> constraints = {makeConstraint({1, 2}), makeConstraint({2, 3})};
+	std::vector<ExclusionConstraint> cliques = ExclusionConstraint::mergeIntoCliques(constraints);
+
+	BOOST_CHECK_EQUAL(cliques.size(), 2);
+	for(const ExclusionConstraint& clique : cliques)
+		BOOST_CHECK_EQUAL(clique.getIds().size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE( MergeKeepsDisjointPairs )
+{
+	std::vector<ExclusionConstraint> constraints = {makeConstraint({1, 2}), makeConstraint({3, 4})};
+	std::vector<ExclusionConstraint> cliques = ExclusionConstraint::mergeIntoCliques(constraints);
+
+	BOOST_CHECK_EQUAL(cliques.size(), 2);
+	std::vector<std::vector<IdLabelType> > ids;
+	for(const ExclusionConstraint& clique : cliques)
+		ids.push_back(sortedIds(clique));
+	std::sort(ids.begin(), ids.end());
+	BOOST_CHECK(ids[0] == makeConstraint({1, 2}).getIds());
+	BOOST_CHECK(ids[1] == makeConstraint({3, 4}).getIds());
+}
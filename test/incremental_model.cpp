@@ -0,0 +1,106 @@
+#define BOOST_TEST_MODULE incremental_model
+
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <set>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "helpers.h"
+#include "settings.h"
+#include "jsonmodel.h"
+#include "incrementalmodel.h"
+
+using namespace mht;
+using namespace helpers;
+
+namespace
+{
+
+IdLabelType toId(int id)
+{
+	return boost::lexical_cast<IdLabelType>(id);
+}
+
+/// the states of all detections of the given frame, keyed by their id, and of the links that leave them, keyed by source and target
+std::map<std::vector<IdLabelType>, size_t> frameStates(const Json::Value& result, const std::set<IdLabelType>& frameDetections)
+{
+	std::map<std::vector<IdLabelType>, size_t> states;
+	const Json::Value& detectionResults = result[JsonTypeNames[JsonTypes::DetectionResults]];
+	for(int i = 0; i < (int)detectionResults.size(); i++)
+	{
+		IdLabelType id = detectionResults[i][JsonTypeNames[JsonTypes::Id]].asLabelType();
+		if(frameDetections.count(id) > 0)
+			states[{id}] = detectionResults[i][JsonTypeNames[JsonTypes::Value]].asUInt();
+	}
+
+	const Json::Value& linkResults = result[JsonTypeNames[JsonTypes::LinkResults]];
+	for(int i = 0; i < (int)linkResults.size(); i++)
+	{
+		IdLabelType srcId = linkResults[i][JsonTypeNames[JsonTypes::SrcId]].asLabelType();
+		IdLabelType destId = linkResults[i][JsonTypeNames[JsonTypes::DestId]].asLabelType();
+		if(frameDetections.count(srcId) > 0)
+			states[{srcId, destId}] = linkResults[i][JsonTypeNames[JsonTypes::Value]].asUInt();
+	}
+	return states;
+}
+
+} // end anonymous namespace
+
+BOOST_AUTO_TEST_CASE( IncrementalModelKeepsFixedFrames )
+{
+	std::ifstream input("flowmodel.json");
+	Json::Value root;
+	input >> root;
+
+	// split the flow model into the frames {1, 2}, {3} and {4, 5}, every link belongs to the frame of its target
+	std::map<IdLabelType, size_t> frameOfDetection = {{toId(1), 0}, {toId(2), 0}, {toId(3), 1}, {toId(4), 2}, {toId(5), 2}};
+	std::vector<Json::Value> frames(3);
+	for(Json::Value& frame : frames)
+	{
+		frame[JsonTypeNames[JsonTypes::Segmentations]] = Json::Value(Json::arrayValue);
+		frame[JsonTypeNames[JsonTypes::Links]] = Json::Value(Json::arrayValue);
+	}
+	const Json::Value& segmentations = root[JsonTypeNames[JsonTypes::Segmentations]];
+	for(int i = 0; i < (int)segmentations.size(); i++)
+		frames[frameOfDetection[segmentations[i][JsonTypeNames[JsonTypes::Id]].asLabelType()]][JsonTypeNames[JsonTypes::Segmentations]].append(segmentations[i]);
+	const Json::Value& links = root[JsonTypeNames[JsonTypes::Links]];
+	for(int i = 0; i < (int)links.size(); i++)
+		frames[frameOfDetection[links[i][JsonTypeNames[JsonTypes::DestId]].asLabelType()]][JsonTypeNames[JsonTypes::Links]].append(links[i]);
+
+	// the window never contains divisions or exclusions, so every re-solve is a min cost flow problem
+	std::shared_ptr<Settings> settings = std::make_shared<Settings>(root[JsonTypeNames[JsonTypes::Settings]]);
+	settings->lookBackHorizon_ = 2;
+	IncrementalModel incrementalModel(settings);
+	incrementalModel.appendFrame(frames[0]);
+	incrementalModel.appendFrame(frames[1]);
+	std::vector<double> weights(incrementalModel.computeNumWeights(), 1.0);
+	incrementalModel.infer(weights);
+
+	// the window of the last frame only contains {3} and {4, 5}, the first frame is fixed from now on
+	std::set<IdLabelType> firstFrame = {toId(1), toId(2)};
+	std::map<std::vector<IdLabelType>, size_t> fixedStates = frameStates(incrementalModel.resultToJson(), firstFrame);
+	BOOST_CHECK_EQUAL(fixedStates.size(), 4);
+
+	incrementalModel.appendFrame(frames[2]);
+	BOOST_CHECK_EQUAL(incrementalModel.computeNumWeights(), weights.size());
+	incrementalModel.infer(weights);
+	Json::Value result = incrementalModel.resultToJson();
+	std::map<std::vector<IdLabelType>, size_t> states = frameStates(result, firstFrame);
+	BOOST_CHECK(states == fixedStates);
+
+	// the overall result is a valid labeling of the full model, here both objects travel through the merger as in the global optimum
+	std::ofstream output("incremental_result.json");
+	output << result << std::endl;
+	output.close();
+
+	JsonModel fullModel;
+	fullModel.readFromJson("flowmodel.json");
+	fullModel.infer(weights);
+	fullModel.setJsonGtFile("incremental_result.json");
+	Solution solution = fullModel.getGroundTruth();
+	BOOST_CHECK(fullModel.verifySolution(solution));
+	BOOST_CHECK_CLOSE(fullModel.evaluateSolution(solution), fullModel.getLastSolutionValue(), 1e-6);
+}
@@ -0,0 +1,37 @@
+#define BOOST_TEST_MODULE length_one_tracks
+
+#include <iostream>
+
+#include <boost/test/unit_test.hpp>
+
+#include "helpers.h"
+#include "settings.h"
+#include "jsonmodel.h"
+
+using namespace mht;
+using namespace helpers;
+
+namespace
+{
+
+bool verifyLengthOneTrack(bool allowLengthOneTracks)
+{
+	JsonModel model;
+	model.readFromJson("flowmodel.json");
+	model.getSettings()->allowLengthOneTracks_ = allowLengthOneTracks;
+
+	// the ground truth can only be read into an initialized model
+	std::vector<double> weights(model.computeNumWeights(), 1.0);
+	model.infer(weights);
+	model.setJsonGtFile("flowlengthonegt.json");
+	Solution solution = model.getGroundTruth();
+	return model.verifySolution(solution);
+}
+
+} // end anonymous namespace
+
+BOOST_AUTO_TEST_CASE( LengthOneTracksRejectedOnlyIfForbidden )
+{
+	BOOST_CHECK(verifyLengthOneTrack(true));
+	BOOST_CHECK(!verifyLengthOneTrack(false));
+}
@@ -0,0 +1,54 @@
+#define BOOST_TEST_MODULE min_cost_flow
+
+#include <iostream>
+
+#include <boost/test/unit_test.hpp>
+
+#include "helpers.h"
+#include "settings.h"
+#include "jsonmodel.h"
+
+using namespace mht;
+using namespace helpers;
+
+BOOST_AUTO_TEST_CASE( MinCostFlowMatchesILP )
+{
+	JsonModel flowModel;
+	flowModel.readFromJson("flowmodel.json");
+	std::vector<double> weights(flowModel.computeNumWeights(), 1.0);
+	Solution flowSolution = flowModel.infer(weights);
+	BOOST_CHECK(flowModel.verifySolution(flowSolution));
+
+	JsonModel ilpModel;
+	ilpModel.readFromJson("flowmodel.json");
+	ilpModel.getSettings()->useMinCostFlowSolver_ = false;
+	ilpModel.getSettings()->useDynamicProgramming_ = false;
+	Solution ilpSolution = ilpModel.infer(weights);
+	BOOST_CHECK(ilpModel.verifySolution(ilpSolution));
+
+	// both objects travel through the merger in detection 3
+	BOOST_CHECK_CLOSE(flowModel.getLastSolutionValue(), -64.0, 1e-6);
+	BOOST_CHECK_CLOSE(flowModel.getLastSolutionValue(), ilpModel.getLastSolutionValue(), 1e-6);
+	BOOST_CHECK_CLOSE(flowModel.evaluateSolution(flowSolution), ilpModel.evaluateSolution(ilpSolution), 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE( FlowHeuristicKeepsChildrenSeparate )
+{
+	JsonModel separateModel;
+	separateModel.readFromJson("flowdivisionmodel.json");
+	std::vector<double> weights(separateModel.computeNumWeights(), 1.0);
+	Solution separateSolution = separateModel.inferWithFlowHeuristic(weights);
+	BOOST_CHECK(separateModel.verifySolution(separateSolution));
+
+	// the second child would have to be detection 3, which costs more than the division gains
+	BOOST_CHECK_CLOSE(separateModel.getLastSolutionValue(), -46.0, 1e-6);
+
+	JsonModel mergedModel;
+	mergedModel.readFromJson("flowdivisionmodel.json");
+	mergedModel.getSettings()->requireSeparateChildrenOfDivision_ = false;
+	Solution mergedSolution = mergedModel.inferWithFlowHeuristic(weights);
+	BOOST_CHECK(mergedModel.verifySolution(mergedSolution));
+
+	// without the constraint both children end up in the merger of detection 2
+	BOOST_CHECK_CLOSE(mergedModel.getLastSolutionValue(), -92.0, 1e-6);
+}
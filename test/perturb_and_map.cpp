@@ -0,0 +1,36 @@
+#define BOOST_TEST_MODULE perturb_and_map
+
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <random>
+
+#include <boost/test/unit_test.hpp>
+
+#include "helpers.h"
+#include "model.h"
+
+using namespace mht;
+using namespace helpers;
+
+BOOST_AUTO_TEST_CASE( GumbelPerturbationSamplesSoftmax )
+{
+	// a merger detection with three states, the minimizer of the perturbed energies must follow softmax(-energies)
+	std::vector<ValueType> energies = {0.0, -1.0, 0.5};
+	double partition = 0.0;
+	for(ValueType e : energies)
+		partition += std::exp(-e);
+
+	const size_t numSamples = 100000;
+	std::vector<size_t> counts(energies.size(), 0);
+	std::mt19937 generator(42);
+	for(size_t k = 0; k < numSamples; ++k)
+	{
+		std::vector<ValueType> perturbed(energies);
+		Model::perturbEnergies(perturbed, 1.0, true, generator);
+		counts[std::min_element(perturbed.begin(), perturbed.end()) - perturbed.begin()]++;
+	}
+
+	for(size_t state = 0; state < energies.size(); ++state)
+		BOOST_CHECK_SMALL(double(counts[state]) / numSamples - std::exp(-energies[state]) / partition, 0.01);
+}
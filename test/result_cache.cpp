@@ -0,0 +1,56 @@
+#define BOOST_TEST_MODULE result_cache
+
+#include <iostream>
+#include <cstdio>
+
+#include <boost/test/unit_test.hpp>
+
+#include "helpers.h"
+#include "resultcache.h"
+
+using namespace mht;
+using namespace helpers;
+
+BOOST_AUTO_TEST_CASE( ResultCacheKeyIgnoresFormatting )
+{
+	Json::Reader reader;
+	Json::Value model, reorderedModel, otherModel;
+	reader.parse("{\"settings\": {\"optimizerEpGap\": 0.01}, \"segmentationHypotheses\": [{\"id\": 1}]}", model);
+	reader.parse("{ \"segmentationHypotheses\" : [ { \"id\" : 1 } ],\n \"settings\" : { \"optimizerEpGap\" : 0.01 } }", reorderedModel);
+	reader.parse("{\"settings\": {\"optimizerEpGap\": 0.02}, \"segmentationHypotheses\": [{\"id\": 1}]}", otherModel);
+	std::vector<double> weights = {1.0, 2.0};
+
+	BOOST_CHECK_EQUAL(ResultCache::computeKey(model, weights, ""), ResultCache::computeKey(reorderedModel, weights, ""));
+	BOOST_CHECK(ResultCache::computeKey(model, weights, "") != ResultCache::computeKey(otherModel, weights, ""));
+	BOOST_CHECK(ResultCache::computeKey(model, weights, "") != ResultCache::computeKey(model, {1.0, 2.5}, ""));
+	BOOST_CHECK(ResultCache::computeKey(model, weights, "") != ResultCache::computeKey(model, weights, "lp-relax=1"));
+}
+
+BOOST_AUTO_TEST_CASE( ResultCacheEvictsLeastRecentlyUsed )
+{
+	Json::Value first, second;
+	first[JsonTypeNames[JsonTypes::ResultEnergy]] = 1.0;
+	second[JsonTypeNames[JsonTypes::ResultEnergy]] = 2.0;
+
+	{
+		// the limit only fits one of the results
+		ResultCache cache(".", 40);
+		cache.store("first", first);
+		Json::Value result;
+		BOOST_CHECK(cache.lookup("first", result));
+		BOOST_CHECK_CLOSE(result[JsonTypeNames[JsonTypes::ResultEnergy]].asDouble(), 1.0, 1e-6);
+
+		cache.store("second", second);
+		BOOST_CHECK_EQUAL(cache.getNumEntries(), 1);
+		BOOST_CHECK(!cache.lookup("first", result));
+	}
+
+	// the index is read again by a new instance
+	ResultCache cache(".", 40);
+	Json::Value result;
+	BOOST_CHECK(cache.lookup("second", result));
+	BOOST_CHECK_CLOSE(result[JsonTypeNames[JsonTypes::ResultEnergy]].asDouble(), 2.0, 1e-6);
+
+	std::remove("second.json");
+	std::remove("index.txt");
+}
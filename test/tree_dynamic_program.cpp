@@ -0,0 +1,35 @@
+#define BOOST_TEST_MODULE tree_dynamic_program
+
+#include <iostream>
+
+#include <boost/test/unit_test.hpp>
+
+#include "helpers.h"
+#include "settings.h"
+#include "jsonmodel.h"
+
+using namespace mht;
+using namespace helpers;
+
+BOOST_AUTO_TEST_CASE( DynamicProgramMatchesILP )
+{
+	// the links of the flow model form a tree, forbidding partial merger appearance rules out the min cost flow solver
+	JsonModel treeModel;
+	treeModel.readFromJson("flowmodel.json");
+	treeModel.getSettings()->allowPartialMergerAppearance_ = false;
+	treeModel.getSettings()->allowLengthOneTracks_ = false;
+	std::vector<double> weights(treeModel.computeNumWeights(), 1.0);
+	Solution treeSolution = treeModel.infer(weights);
+	BOOST_CHECK(treeModel.verifySolution(treeSolution));
+
+	JsonModel ilpModel;
+	ilpModel.readFromJson("flowmodel.json");
+	ilpModel.getSettings()->allowPartialMergerAppearance_ = false;
+	ilpModel.getSettings()->allowLengthOneTracks_ = false;
+	ilpModel.getSettings()->useDynamicProgramming_ = false;
+	Solution ilpSolution = ilpModel.infer(weights);
+	BOOST_CHECK(ilpModel.verifySolution(ilpSolution));
+
+	BOOST_CHECK_CLOSE(treeModel.getLastSolutionValue(), ilpModel.getLastSolutionValue(), 1e-6);
+	BOOST_CHECK_CLOSE(treeModel.evaluateSolution(treeSolution), ilpModel.evaluateSolution(ilpSolution), 1e-6);
+}